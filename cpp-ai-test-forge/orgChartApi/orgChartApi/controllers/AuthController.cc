@@ -1,6 +1,12 @@
-#include <third_party/libbcrypt/include/bcrypt/BCrypt.hpp>
 #include "AuthController.h"
 #include "../plugins/JwtPlugin.h"
+#include "../plugins/PasswordHasherPlugin.h"
+#include "../utils/utils.h"
+#include <drogon/orm/CoroMapper.h>
+#include <exception>
+#include <optional>
+#include <string>
+#include <vector>
 
 using namespace drogon::orm;
 using namespace drogon_model::org_chart;
@@ -8,115 +14,77 @@ using namespace drogon_model::org_chart;
 namespace drogon {
     template<>
     inline User fromRequest(const HttpRequest &req) {
+        // no body: a user without fields, which areFieldsValid turns away
         auto jsonPtr = req.getJsonObject();
-        auto json = *jsonPtr;
-        auto user = User(json);
-        return user;
+        return jsonPtr ? User(*jsonPtr) : User();
     }
 }
 
-void AuthController::registerUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, User &&pUser) const {
+Task<HttpResponsePtr> AuthController::registerUser(HttpRequestPtr req, User pUser) const {
     LOG_DEBUG << "registerUser";
-    try {
-        auto dbClientPtr = drogon::app().getDbClient();
-        Mapper<User> mp(dbClientPtr);
-
-        if (!areFieldsValid(pUser)) {
-            Json::Value ret{};
-            ret["error"] = "missing fields";
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k400BadRequest);
-            callback(resp);
-            return;
-        }
+    if (!areFieldsValid(pUser)) co_return newErrResponse("missing fields");
 
-        if (!isUserAvailable(pUser, mp)) {
-            Json::Value ret{};
-            ret["error"] = "username is taken";
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k400BadRequest);
-            callback(resp);
-            return;
+    User newUser;
+    try {
+        CoroMapper<User> mp(drogon::app().getDbClient());
+        auto taken = co_await mp.count(Criteria(User::Cols::_username, CompareOperator::EQ, pUser.getValueOfUsername()));
+        if (taken > 0) co_return newErrResponse("username is taken");
+
+        auto *hasherPtr = drogon::app().getPlugin<PasswordHasherPlugin>();
+        std::optional<std::string> hash;
+        try {
+            hash = co_await hasherPtr->hash(pUser.getValueOfPassword());
+        } catch (const std::exception & e) {
+            // bcrypt failing on the hasher's pool
+            LOG_ERROR << e.what();
+            co_return newErrResponse("password hashing failed", k500InternalServerError);
         }
-
-        auto newUser = pUser;
-        newUser.setPassword(BCrypt::generateHash(newUser.getValueOfPassword()));
-        mp.insertFuture(newUser).get();
-
-        auto userWithToken = AuthController::UserWithToken(newUser);
-        Json::Value ret = userWithToken.toJson();
-        auto resp = HttpResponse::newHttpJsonResponse(ret);
-        resp->setStatusCode(HttpStatusCode::k201Created);
-        callback(resp);
+        if (!hash) co_return hasherPtr->busyResponse();
+        pUser.setPassword(*hash);
+        newUser = co_await mp.insert(pUser);
     } catch (const DrogonDbException & e) {
         LOG_ERROR << e.base().what();
-        Json::Value ret{};
-        ret["error"] = "database error";
-        auto resp = HttpResponse::newHttpJsonResponse(ret);
-        resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-        callback(resp);
+        co_return newErrResponse("database error", k500InternalServerError);
     }
+
+    auto userWithToken = AuthController::UserWithToken(newUser);
+    auto resp = HttpResponse::newHttpJsonResponse(userWithToken.toJson());
+    resp->setStatusCode(HttpStatusCode::k201Created);
+    co_return resp;
 }
 
-void AuthController::loginUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, User &&pUser) const {
+Task<HttpResponsePtr> AuthController::loginUser(HttpRequestPtr req, User pUser) const {
     LOG_DEBUG << "loginUser";
-    try {
-        auto dbClientPtr = drogon::app().getDbClient();
-        Mapper<User> mp(dbClientPtr);
-
-        if (!areFieldsValid(pUser)) {
-            Json::Value ret{};
-            ret["error"] = "missing fields";
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k400BadRequest);
-            callback(resp);
-            return;
-        }
-
-        auto user = mp.findFutureBy(Criteria(User::Cols::_username, CompareOperator::EQ, pUser.getValueOfUsername())).get();
-        if (user.empty()) {
-            Json::Value ret{};
-            ret["error"] = "user not found";
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k400BadRequest);
-            callback(resp);
-            return;
-        }
+    if (!areFieldsValid(pUser)) co_return newErrResponse("missing fields");
 
-        if (!isPasswordValid(pUser.getValueOfPassword(), user[0].getValueOfPassword())) {
-            Json::Value ret{};
-            ret["error"] = "username and password do not match";
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k401Unauthorized);
-            callback(resp);
-            return;
-        }
-
-        auto userWithToken = AuthController::UserWithToken(user[0]);
-        auto ret = userWithToken.toJson();
-        auto resp = HttpResponse::newHttpJsonResponse(ret);
-        callback(resp);
+    std::vector<User> user;
+    try {
+        CoroMapper<User> mp(drogon::app().getDbClient());
+        user = co_await mp.findBy(Criteria(User::Cols::_username, CompareOperator::EQ, pUser.getValueOfUsername()));
     } catch (const DrogonDbException & e) {
         LOG_ERROR << e.base().what();
-        Json::Value ret{};
-        ret["error"] = "database error";
-        auto resp = HttpResponse::newHttpJsonResponse(ret);
-        resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-        callback(resp);
+        co_return newErrResponse("database error", k500InternalServerError);
     }
-}
+    if (user.empty()) co_return newErrResponse("user not found");
 
-bool AuthController::areFieldsValid(const User &user) const {
-    return user.getUsername() != nullptr && user.getPassword() != nullptr;
-}
+    auto *hasherPtr = drogon::app().getPlugin<PasswordHasherPlugin>();
+    std::optional<bool> matches;
+    try {
+        matches = co_await hasherPtr->verify(pUser.getValueOfPassword(), user[0].getValueOfPassword());
+    } catch (const std::exception & e) {
+        // bcrypt failing on the hasher's pool, on a malformed stored hash say
+        LOG_ERROR << e.what();
+        co_return newErrResponse("password check failed", k500InternalServerError);
+    }
+    if (!matches) co_return hasherPtr->busyResponse();
+    if (!*matches) co_return newErrResponse("username and password do not match", k401Unauthorized);
 
-bool AuthController::isUserAvailable(const User &user, Mapper<User> &mp) const {
-    auto criteria = Criteria(User::Cols::_username, CompareOperator::EQ, user.getValueOfUsername());
-    return mp.findFutureBy(criteria).get().empty();
+    auto userWithToken = AuthController::UserWithToken(user[0]);
+    co_return HttpResponse::newHttpJsonResponse(userWithToken.toJson());
 }
 
-bool AuthController::isPasswordValid(const std::string &text, const std::string &hash) const {
-    return BCrypt::validatePassword(text, hash);
+bool AuthController::areFieldsValid(const User &user) const {
+    return user.getUsername() != nullptr && user.getPassword() != nullptr;
 }
 
 AuthController::UserWithToken::UserWithToken(const User &user) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <drogon/utils/coroutine.h>
 #include <string>
 #include "../models/User.h"
 
@@ -15,8 +16,8 @@ class AuthController : public drogon::HttpController<AuthController> {
       ADD_METHOD_TO(AuthController::loginUser, "/auth/login", Post);
     METHOD_LIST_END
 
-    void registerUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, User &&pUser) const;
-    void loginUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, User &&pUser) const;
+    Task<HttpResponsePtr> registerUser(HttpRequestPtr req, User pUser) const;
+    Task<HttpResponsePtr> loginUser(HttpRequestPtr req, User pUser) const;
 
  private:
     struct UserWithToken {
@@ -28,6 +29,4 @@ class AuthController : public drogon::HttpController<AuthController> {
     };
 
     bool areFieldsValid(const User &user) const;
-    bool isUserAvailable(const User &user, Mapper<User> &mp) const;
-    bool isPasswordValid(const std::string &text, const std::string &hash) const;
 };
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <drogon/orm/CoroMapper.h>
+#include <drogon/utils/coroutine.h>
+#include "../utils/utils.h"
+#include "../utils/ModelJson.h"
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// What Crud<Model> needs beyond the generated model. Specialise it next to
+// the controller, e.g.
+//   template <> struct CrudTraits<Job> { static constexpr RowCountPlugin::Table table = RowCountPlugin::Table::Job; };
+template <typename Model>
+struct CrudTraits;
+
+// List, get, create, partial update and delete for a plain table. Table,
+// key, columns and validation all come from the drogon generated model;
+// the table's row counter and version come from CrudTraits<Model>::table.
+// Every database call is co_awaited, so nothing here blocks the IO thread.
+template <typename Model>
+class Crud {
+ public:
+    using Response = drogon::Task<drogon::HttpResponsePtr>;
+
+    // ?limit&offset&sort_field&sort_order, or ?limit&cursor
+    static Response list(drogon::HttpRequestPtr req);
+    static Response getOne(drogon::HttpRequestPtr req, int id);
+    static Response createOne(drogon::HttpRequestPtr req);
+    // sets only the columns present in the JSON body
+    static Response updateOne(drogon::HttpRequestPtr req, int id);
+    static Response deleteOne(drogon::HttpRequestPtr req, int id);
+
+ private:
+    static constexpr auto table = CrudTraits<Model>::table;
+
+    static drogon::HttpResponsePtr databaseError(const drogon::orm::DrogonDbException &e) {
+        LOG_ERROR << e.base().what();
+        return newErrResponse("database error", drogon::k500InternalServerError);
+    }
+};
+
+template <typename Model>
+typename Crud<Model>::Response Crud<Model>::list(drogon::HttpRequestPtr req) {
+    using namespace drogon::orm;
+    auto etag = drogon::app().getPlugin<TableVersionPlugin>()->etag({table});
+    if (auto resp = notModifiedResponse(req, etag)) co_return resp;
+    auto *cachePtr = drogon::app().getPlugin<ResponseCachePlugin>();
+    auto cacheKey = ResponseCachePlugin::keyOf(req);
+    if (auto resp = cachePtr->cached(req, cacheKey, etag)) co_return resp;
+    auto pageOffset = pageOffsetOf(req);
+    auto pageLimit = pageLimitOf(req);
+    if (!pageLimit || !pageOffset) co_return newErrResponse("limit and offset must not be negative");
+    auto offset = *pageOffset;
+    auto limit = *pageLimit;
+    auto sortField = req->getOptionalParameter<std::string>("sort_field").value_or(Model::primaryKeyName);
+    auto sortOrder = req->getOptionalParameter<std::string>("sort_order").value_or("asc");
+    auto cursorToken = req->getOptionalParameter<std::string>("cursor");
+
+    // a cursor carries the sort it was issued for and replaces offset
+    std::optional<PageCursor> cursor;
+    if (cursorToken) {
+        cursor = decodeCursor(*cursorToken);
+        if (!cursor) co_return newErrResponse("invalid cursor");
+        sortField = cursor->sortField;
+        sortOrder = cursor->sortOrder;
+    }
+    // sort_field ends up in the SQL, so only real columns get through
+    auto knownField = false;
+    for (std::size_t i = 0; i < Model::getColumnNumber(); ++i) {
+        if (Model::getColumnName(i) == sortField) knownField = true;
+    }
+    if (!knownField) co_return newErrResponse("unknown sort_field " + sortField);
+    auto sortOrderEnum = sortOrder == "asc" ? SortOrder::ASC : SortOrder::DESC;
+    sortOrder = sortOrderEnum == SortOrder::ASC ? "asc" : "desc";
+
+    auto page = std::make_shared<std::vector<Model>>();
+    try {
+        CoroMapper<Model> mp(drogon::app().getDbClient());
+        mp.orderBy(sortField, sortOrderEnum);
+        mp.orderBy(Model::primaryKeyName, sortOrderEnum);
+        mp.limit(limit);
+        if (!cursor) {
+            mp.offset(offset);
+            *page = co_await mp.findAll();
+        } else {
+            // a row comparison, so (sort key, id) seeks straight to the next page
+            auto seek = "(" + sortField + ", " + Model::primaryKeyName + ") " + (sortOrderEnum == SortOrder::ASC ? ">" : "<") + " ($?, $?)";
+            *page = co_await mp.findBy(Criteria(CustomSql(seek), cursor->key, cursor->id));
+        }
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
+    }
+
+    auto fill = cachePtr->fill(cacheKey, etag);
+    auto resp = newJsonArrayStreamResponse(page->size(), [page](std::size_t i, std::string &out) {
+        appendJson(out, (*page)[i]);
+    }, fill);
+    addTotalCountHeader(resp, table);
+    resp->addHeader("ETag", etag);
+    // a short page is the last one
+    if (!page->empty() && page->size() == static_cast<std::size_t>(limit)) {
+        auto last = page->back().toJson();
+        resp->addHeader("X-Next-Cursor", encodeCursor({
+            sortField,
+            sortOrder,
+            last[Model::primaryKeyName].asInt(),
+            last[sortField].asString()}));
+    }
+    fill->keepHeaders(resp);
+    co_return resp;
+}
+
+template <typename Model>
+typename Crud<Model>::Response Crud<Model>::getOne(drogon::HttpRequestPtr req, int id) {
+    using namespace drogon::orm;
+    auto etag = drogon::app().getPlugin<TableVersionPlugin>()->etag({table});
+    if (auto resp = notModifiedResponse(req, etag)) co_return resp;
+
+    Result result(nullptr);
+    try {
+        result = co_await drogon::app().getDbClient()->execSqlCoro(Model::sqlForFindingByPrimaryKey(), id);
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
+    }
+    if (result.empty()) co_return newErrResponse("resource not found", drogon::k404NotFound);
+
+    std::string body;
+    appendJson(body, Model(result[0]));
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    resp->setBody(std::move(body));
+    resp->addHeader("ETag", etag);
+    co_return resp;
+}
+
+template <typename Model>
+typename Crud<Model>::Response Crud<Model>::createOne(drogon::HttpRequestPtr req) {
+    using namespace drogon::orm;
+    auto jsonPtr = req->getJsonObject();
+    if (!jsonPtr) co_return newErrResponse("expected a json object");
+    std::string err;
+    if (!Model::validateJsonForCreation(*jsonPtr, err)) co_return newErrResponse(err);
+
+    Model row;
+    try {
+        CoroMapper<Model> mp(drogon::app().getDbClient());
+        row = co_await mp.insert(Model(*jsonPtr));
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
+    }
+    drogon::app().getPlugin<RowCountPlugin>()->added(table);
+    drogon::app().getPlugin<TableVersionPlugin>()->changed(table);
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(row.toJson());
+    resp->setStatusCode(drogon::k201Created);
+    co_return resp;
+}
+
+template <typename Model>
+typename Crud<Model>::Response Crud<Model>::updateOne(drogon::HttpRequestPtr req, int id) {
+    using namespace drogon::orm;
+    auto jsonPtr = req->getJsonObject();
+    if (!jsonPtr || !jsonPtr->isObject()) co_return newErrResponse("expected a json object");
+
+    // one statement per set of columns present, so each is prepared once
+    std::string sql = "update " + Model::tableName + " set ";
+    std::vector<std::size_t> columns;
+    for (std::size_t i = 0; i < Model::getColumnNumber(); ++i) {
+        const auto &column = Model::getColumnName(i);
+        if (column == Model::primaryKeyName || !jsonPtr->isMember(column)) continue;
+        std::string err;
+        if (!Model::validJsonOfField(i, column, (*jsonPtr)[column], err, false)) co_return newErrResponse(err);
+        columns.push_back(i);
+        if (columns.size() > 1) sql += ", ";
+        sql += column + " = $" + std::to_string(columns.size());
+    }
+    if (columns.empty()) co_return newErrResponse("nothing to update");
+    sql += " where " + Model::primaryKeyName + " = $" + std::to_string(columns.size() + 1);
+
+    Result result(nullptr);
+    try {
+        auto binder = *drogon::app().getDbClient() << std::move(sql);
+        for (auto i : columns) bindJsonValue(binder, (*jsonPtr)[Model::getColumnName(i)]);
+        binder << id;
+        result = co_await drogon::orm::internal::SqlAwaiter(std::move(binder));
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
+    }
+    if (result.affectedRows() == 0) co_return newErrResponse("resource not found", drogon::k404NotFound);
+
+    drogon::app().getPlugin<TableVersionPlugin>()->changed(table);
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setStatusCode(drogon::k204NoContent);
+    co_return resp;
+}
+
+template <typename Model>
+typename Crud<Model>::Response Crud<Model>::deleteOne(drogon::HttpRequestPtr req, int id) {
+    using namespace drogon::orm;
+    Result result(nullptr);
+    try {
+        result = co_await drogon::app().getDbClient()->execSqlCoro(Model::sqlForDeletingByPrimaryKey(), id);
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
+    }
+    if (result.affectedRows() == 0) co_return newErrResponse("resource not found", drogon::k404NotFound);
+
+    drogon::app().getPlugin<RowCountPlugin>()->removed(table, result.affectedRows());
+    drogon::app().getPlugin<TableVersionPlugin>()->changed(table);
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setStatusCode(drogon::k204NoContent);
+    co_return resp;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <drogon/utils/coroutine.h>
 #include "../models/Department.h"
 
 using namespace drogon;
@@ -17,10 +18,10 @@ class DepartmentsController : public drogon::HttpController<DepartmentsControlle
       ADD_METHOD_TO(DepartmentsController::getDepartmentPersons, "/departments/{1}/persons", Get, "LoginFilter");
     METHOD_LIST_END
 
-    void get(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback) const;
-    void getOne(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback, int pDepartmentId) const;
-    void createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Department &&pDepartment) const;
-    void updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pDepartmentId, Department &&pDepartment) const;
-    void deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pDepartmentId) const;
-    void getDepartmentPersons(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int departmentId) const;
+    Task<HttpResponsePtr> get(HttpRequestPtr req) const;
+    Task<HttpResponsePtr> getOne(HttpRequestPtr req, int pDepartmentId) const;
+    Task<HttpResponsePtr> createOne(HttpRequestPtr req) const;
+    Task<HttpResponsePtr> updateOne(HttpRequestPtr req, int pDepartmentId) const;
+    Task<HttpResponsePtr> deleteOne(HttpRequestPtr req, int pDepartmentId) const;
+    Task<HttpResponsePtr> getDepartmentPersons(HttpRequestPtr req, int departmentId) const;
 };
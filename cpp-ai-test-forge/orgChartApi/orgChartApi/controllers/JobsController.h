@@ -1,6 +1,7 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <drogon/utils/coroutine.h>
 #include "../models/Job.h"
 
 using namespace drogon;
@@ -17,10 +18,10 @@ class JobsController : public drogon::HttpController<JobsController> {
       ADD_METHOD_TO(JobsController::getJobPersons, "/jobs/{1}/persons", Get, "LoginFilter");
     METHOD_LIST_END
 
-    void get(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback) const;
-    void getOne(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback, int pJobId) const;
-    void createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Job &&pJob) const;
-    void updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pJobId, Job &&pJob) const;
-    void deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pJobId) const;
-    void getJobPersons(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int jobId) const;
+    Task<HttpResponsePtr> get(HttpRequestPtr req) const;
+    Task<HttpResponsePtr> getOne(HttpRequestPtr req, int pJobId) const;
+    Task<HttpResponsePtr> createOne(HttpRequestPtr req) const;
+    Task<HttpResponsePtr> updateOne(HttpRequestPtr req, int pJobId) const;
+    Task<HttpResponsePtr> deleteOne(HttpRequestPtr req, int pJobId) const;
+    Task<HttpResponsePtr> getJobPersons(HttpRequestPtr req, int jobId) const;
 };
@@ -0,0 +1,97 @@
+#include "OrgChartController.h"
+#include "../plugins/OrgChartWriter.h"
+#include "../plugins/OrgIndexPlugin.h"
+#include "../utils/utils.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+// Layout for the ?root= subtree, or nullptr with an error response sent. Without
+// root the single top-level person is used.
+std::shared_ptr<const OrgLayout> requestedLayout(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &callback) {
+    auto *orgIndexPtr = drogon::app().getPlugin<OrgIndexPlugin>();
+    if (!orgIndexPtr->isReady()) {
+        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("org index is loading"));
+        resp->setStatusCode(HttpStatusCode::k503ServiceUnavailable);
+        callback(resp);
+        return nullptr;
+    }
+
+    auto rootId = req->getOptionalParameter<int>("root");
+    if (!rootId) {
+        auto roots = orgIndexPtr->read([](const OrgIndex &index) { return index.roots(); });
+        if (roots.size() != 1) {
+            badRequest(std::move(callback), "root is required when the org has more than one top-level person");
+            return nullptr;
+        }
+        rootId = roots.front();
+    }
+
+    auto layout = orgIndexPtr->layoutOf(*rootId);
+    if (!layout) {
+        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+        resp->setStatusCode(HttpStatusCode::k404NotFound);
+        callback(resp);
+    }
+    return layout;
+}
+
+// The body is written from the cached layout, which is immutable, so org
+// writes during a long download cannot tear the document.
+HttpResponsePtr streamChart(std::shared_ptr<const OrgLayout> layout, OrgChartWriter::Format format) {
+    auto version = layout->version;
+    auto writer = std::make_shared<OrgChartWriter>(std::move(layout), format);
+    auto resp = HttpResponse::newStreamResponse(
+        [writer](char *buf, std::size_t len) -> std::size_t {
+            // a null buffer means the client went away
+            return buf ? writer->read(buf, len) : 0;
+        },
+        "",
+        format == OrgChartWriter::Format::Svg ? CT_IMAGE_SVG_XML : CT_CUSTOM,
+        format == OrgChartWriter::Format::Svg ? "" : "text/vnd.graphviz; charset=utf-8");
+    resp->addHeader("X-Org-Version", std::to_string(version));
+    return resp;
+}
+}  // namespace
+
+void OrgChartController::getLayout(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
+    LOG_DEBUG << "getLayout";
+    auto layout = requestedLayout(req, callback);
+    if (!layout) return;
+
+    Json::Value ret{};
+    ret["root"] = layout->nodes.front().id;
+    ret["org_version"] = static_cast<Json::UInt64>(layout->version);
+    ret["width"] = layout->width;
+    ret["height"] = layout->height;
+    ret["nodes"] = Json::Value{Json::arrayValue};
+    for (const auto &node : layout->nodes) {
+        Json::Value item{};
+        item["id"] = node.id;
+        item["manager_id"] = node.managerId;
+        item["first_name"] = node.firstName;
+        item["last_name"] = node.lastName;
+        item["x"] = node.x;
+        item["y"] = node.y;
+        ret["nodes"].append(item);
+    }
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->setStatusCode(HttpStatusCode::k200OK);
+    resp->addHeader("X-Org-Version", std::to_string(layout->version));
+    callback(resp);
+}
+
+void OrgChartController::exportSvg(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
+    LOG_DEBUG << "exportSvg";
+    auto layout = requestedLayout(req, callback);
+    if (!layout) return;
+    callback(streamChart(std::move(layout), OrgChartWriter::Format::Svg));
+}
+
+void OrgChartController::exportDot(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
+    LOG_DEBUG << "exportDot";
+    auto layout = requestedLayout(req, callback);
+    if (!layout) return;
+    callback(streamChart(std::move(layout), OrgChartWriter::Format::Dot));
+}
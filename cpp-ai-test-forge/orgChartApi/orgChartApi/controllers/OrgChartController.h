@@ -0,0 +1,18 @@
+#pragma once
+
+#include <drogon/HttpController.h>
+
+using namespace drogon;
+
+class OrgChartController : public drogon::HttpController<OrgChartController> {
+ public:
+    METHOD_LIST_BEGIN
+      ADD_METHOD_TO(OrgChartController::getLayout, "/orgchart/layout", Get, "LoginFilter");
+      ADD_METHOD_TO(OrgChartController::exportSvg, "/orgchart/export.svg", Get, "LoginFilter");
+      ADD_METHOD_TO(OrgChartController::exportDot, "/orgchart/export.dot", Get, "LoginFilter");
+    METHOD_LIST_END
+
+    void getLayout(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const;
+    void exportSvg(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const;
+    void exportDot(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const;
+};
@@ -1,9 +1,23 @@
 #include "PersonsController.h"
 #include "../utils/utils.h"
+#include "../utils/ModelJson.h"
+#include "../plugins/OrgIndexPlugin.h"
+#include "../plugins/PersonLoaderPlugin.h"
+#include "../plugins/ReorgDraft.h"
+#include "../models/PersonClosure.h"
+#include <drogon/orm/CoroMapper.h>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
-#include <regex>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
 
 using namespace drogon::orm;
 using namespace drogon_model::org_chart;
@@ -11,7 +25,9 @@ using namespace drogon_model::org_chart;
 namespace drogon {
     template<>
     inline Person fromRequest(const HttpRequest &req) {
+        // no body: a person with no fields set
         auto jsonPtr = req.getJsonObject();
+        if (!jsonPtr) return Person();
         auto json = *jsonPtr;
         if (json["department_id"]) json["department_id"] = std::stoi(json["department_id"].asString());
         if (json["manager_id"]) json["manager_id"] = std::stoi(json["manager_id"].asString());
@@ -21,268 +37,743 @@ namespace drogon {
     }
 }  // namespace drogon
 
-void PersonsController::get(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
+namespace {
+Json::Value orgEntryToJson(const OrgIndex::Entry &entry) {
+    Json::Value ret{};
+    ret["id"] = entry.id;
+    ret["manager_id"] = entry.managerId;
+    ret["department_id"] = entry.departmentId;
+    ret["job_id"] = entry.jobId;
+    ret["first_name"] = entry.firstName;
+    ret["last_name"] = entry.lastName;
+    return ret;
+}
+
+// sort fields /persons accepts, and the column each one reads
+const std::unordered_map<std::string, std::string> kPersonSortColumns = {
+    {"id", "person.id"},
+    {"first_name", "person.first_name"},
+    {"last_name", "person.last_name"},
+    {"hire_date", "person.hire_date"},
+    {"manager_id", "person.manager_id"},
+    {"department_id", "person.department_id"},
+    {"job_id", "person.job_id"},
+    {"job_title", "job.title"},
+    {"department_name", "department.name"},
+};
+
+// optional /persons filters: the query parameter, the predicate it adds with
+// $? standing for its placeholder, and the kind of value it takes
+enum class FilterValue { Id, IdList, Date };
+struct PersonFilter {
+    const char *param;
+    const char *predicate;
+    FilterValue value;
+};
+const PersonFilter kPersonFilters[] = {
+    {"ids", "person.id = any($?)", FilterValue::IdList},
+    {"department_id", "person.department_id = $?", FilterValue::Id},
+    {"job_id", "person.job_id = $?", FilterValue::Id},
+    {"manager_id", "person.manager_id = $?", FilterValue::Id},
+    {"hired_after", "person.hire_date > $?", FilterValue::Date},
+    {"hired_before", "person.hire_date < $?", FilterValue::Date},
+};
+constexpr unsigned kIdsFilter = 1u << 0;
+constexpr std::size_t kPersonFilterCount = sizeof(kPersonFilters) / sizeof(kPersonFilters[0]);
+
+// filter values are checked up front; a bad one would only fail later as a
+// database error
+bool isId(const std::string &text) {
+    if (text.empty() || text.size() > 9) return false;
+    for (auto c : text) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) return false;
+    }
+    return true;
+}
+
+// 1,2,3
+bool isIdList(const std::string &text) {
+    std::size_t start = 0;
+    while (start <= text.size()) {
+        auto end = std::min(text.find(',', start), text.size());
+        if (!isId(text.substr(start, end - start))) return false;
+        start = end + 1;
+    }
+    return true;
+}
+
+// YYYY-MM-DD
+bool isIsoDate(const std::string &text) {
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (i != 4 && i != 7 && !std::isdigit(static_cast<unsigned char>(text[i]))) return false;
+    }
+    return true;
+}
+
+// ?fields= names and the members of the /persons shape they select
+const std::unordered_map<std::string, unsigned> kPersonFieldNames = {
+    {"id", kPersonId},
+    {"first_name", kPersonFirstName},
+    {"last_name", kPersonLastName},
+    {"hire_date", kPersonHireDate},
+    {"manager", kPersonManager},
+    {"department", kPersonDepartment},
+    {"job", kPersonJob},
+};
+
+// comma separated ?fields= list; empty if it names an unknown field
+std::optional<unsigned> parsePersonFields(const std::string &list) {
+    unsigned fields = 0;
+    std::size_t start = 0;
+    while (start <= list.size()) {
+        auto end = std::min(list.find(',', start), list.size());
+        auto field = kPersonFieldNames.find(list.substr(start, end - start));
+        if (field == kPersonFieldNames.end()) return std::nullopt;
+        fields |= field->second;
+        start = end + 1;
+    }
+    return fields;
+}
+
+// the joins a response needs, as the kPersonManager/Department/Job bits: one
+// per nested member asked for
+unsigned personJoins(unsigned fields) {
+    return fields & (kPersonManager | kPersonDepartment | kPersonJob);
+}
+
+// select list and joins of the /persons shape. Columns of a join left out
+// read as null, so PersonInfo still finds every column it expects.
+std::string personSelectSql(unsigned joins) {
+    std::string sql = "select person.*, \n";
+    sql += joins & kPersonJob ? "job.title as job_title, \n" : "null::varchar as job_title, \n";
+    sql += joins & kPersonDepartment ? "department.name as department_name, \n" : "null::varchar as department_name, \n";
+    sql += joins & kPersonManager ? "concat(manager.first_name, ' ', manager.last_name) as manager_full_name \n"
+                                  : "null::text as manager_full_name \n";
+    sql += "from person \n";
+    if (joins & kPersonJob) sql += "join job on person.job_id = job.id \n";
+    if (joins & kPersonDepartment) sql += "join department on person.department_id = department.id \n";
+    if (joins & kPersonManager) sql += "join person as manager on person.manager_id = manager.id \n";
+    return sql;
+}
+
+// GET /persons/{id} lookups, batched by PersonLoaderPlugin; one statement
+// per set of joins
+const std::string &personsByIdsSql(unsigned joins) {
+    static const auto statements = [] {
+        std::array<std::string, 8> ret;
+        for (unsigned i = 0; i < ret.size(); ++i) {
+            ret[i] = personSelectSql(i << 4) + "where person.id = any($1::int[])";
+        }
+        return ret;
+    }();
+    static_assert(kPersonManager == 1u << 4 && kPersonJob == 1u << 6, "joins index statements by bits 4-6");
+    return statements[joins >> 4];
+}
+
+// $1 limit, $2 offset, $3 the under manager id, then one value per
+// kPersonFilters entry and the cursor (key, id) when seeking. A filter left
+// out is bound as null and its predicate holds for every row, so the text
+// only depends on the sort and on whether a cursor is used. Every page reads
+// all three joins; appendJson leaves out the members ?fields= did not ask for.
+std::string buildPersonsPageSql(const std::string &column, const std::string &order, bool seek) {
+    auto sql = personSelectSql(kPersonManager | kPersonDepartment | kPersonJob);
+    // probes the (ancestor_id, descendant_id) key; nothing the size of the
+    // subtree is built or sent per page
+    sql += "where ($3::int is null or exists (select 1 from person_closure \n\
+            where person_closure.ancestor_id = $3::int and person_closure.descendant_id = person.id \n\
+            and person_closure.depth > 0)) \n";
+    auto param = 4;
+    for (const auto &filter : kPersonFilters) {
+        auto cast = filter.value == FilterValue::Date ? "::date" : filter.value == FilterValue::IdList ? "::int[]" : "::int";
+        auto placeholder = "$" + std::to_string(param++) + cast;
+        std::string predicate = filter.predicate;
+        predicate.replace(predicate.find("$?"), 2, placeholder);
+        sql += "and (" + placeholder + " is null or " + predicate + ") \n";
+    }
+    if (seek) {
+        // a row comparison, so (sort key, id) seeks straight to the next page
+        sql += "and (" + column + ", person.id) " + (order == "asc" ? ">" : "<") +
+               " ($" + std::to_string(param) + ", $" + std::to_string(param + 1) + "::int) \n";
+    }
+    sql += "order by " + column + " " + order + ", person.id " + order + " \n\
+            limit $1 offset $2;";
+    return sql;
+}
+
+// /persons page queries, one per sort field, order and cursor use, all
+// built when the server starts. The texts never change, so the client
+// prepares each one once per connection and later requests only bind values.
+using PersonsPageKey = std::tuple<std::string, std::string, bool>;
+const std::map<PersonsPageKey, std::string> kPersonsPageSql = [] {
+    std::map<PersonsPageKey, std::string> ret;
+    for (const auto &[field, column] : kPersonSortColumns) {
+        for (const char *order : {"asc", "desc"}) {
+            for (auto seek : {false, true}) {
+                ret.emplace(PersonsPageKey{field, order, seek}, buildPersonsPageSql(column, order, seek));
+            }
+        }
+    }
+    return ret;
+}();
+
+OrgIndex::Entry personToOrgEntry(const Person &person) {
+    return {
+        person.getValueOfId(),
+        person.getValueOfManagerId(),
+        person.getValueOfDepartmentId(),
+        person.getValueOfJobId(),
+        person.getValueOfFirstName(),
+        person.getValueOfLastName()};
+}
+
+HttpResponsePtr databaseError(const DrogonDbException &e) {
+    LOG_ERROR << e.base().what();
+    return newErrResponse("database error", k500InternalServerError);
+}
+
+HttpResponsePtr indexLoadingResponse() {
+    return newErrResponse("org index is loading", k503ServiceUnavailable);
+}
+
+// person_closure upkeep. These run inside the transaction that writes the
+// person rows, so the closure never disagrees with manager_id; deletes are
+// covered by the ON DELETE CASCADE foreign keys.
+Task<> insertIntoClosure(std::shared_ptr<Transaction> transPtr, int32_t personId, int32_t managerId) {
+    const char *sql = "insert into person_closure (ancestor_id, descendant_id, depth) \n\
+                       select ancestor_id, $1::int, depth + 1 from person_closure \n\
+                       where descendant_id = $2::int and $1::int <> $2::int \n\
+                       union all select $1::int, $1::int, 0";
+    co_await transPtr->execSqlCoro(sql, personId, managerId);
+}
+
+// Re-parents the subtrees of (person id, new manager id) pairs. Every moved
+// subtree is cut loose before any is re-attached, so a batch that swaps
+// managers around never passes through a cycle.
+Task<> moveInClosure(std::shared_ptr<Transaction> transPtr, std::vector<std::pair<int32_t, int32_t>> moves) {
+    if (moves.empty()) co_return;
+    std::vector<int32_t> ids;
+    ids.reserve(moves.size());
+    for (const auto &move : moves) ids.push_back(move.first);
+
+    // links into a moved subtree from above its root are the ones deeper
+    // than the root's own link to the same descendant
+    const char *detachSql = "delete from person_closure as link \n\
+                             using person_closure as moved \n\
+                             where moved.ancestor_id = any($1::int[]) \n\
+                             and link.descendant_id = moved.descendant_id \n\
+                             and link.depth > moved.depth";
+    co_await transPtr->execSqlCoro(detachSql, toPgIntArray(ids));
+
+    const char *attachSql = "insert into person_closure (ancestor_id, descendant_id, depth) \n\
+                             select above.ancestor_id, below.descendant_id, above.depth + below.depth + 1 \n\
+                             from person_closure as above, person_closure as below \n\
+                             where above.descendant_id = $2 and below.ancestor_id = $1";
+    for (const auto &move : moves) {
+        // roots have nothing above them
+        if (move.first == move.second) continue;
+        co_await transPtr->execSqlCoro(attachSql, move.first, move.second);
+    }
+}
+
+// Applies the members the request carried in one statement and gives back
+// the row as it ended up, plus the manager it had before. No row means no
+// such person.
+drogon::orm::internal::SqlAwaiter patchPerson(const std::shared_ptr<DbClient> &clientPtr, int32_t personId, const Person &patch) {
+    const char *sql = "update person set \n\
+                       first_name = coalesce($2, person.first_name), \n\
+                       last_name = coalesce($3, person.last_name), \n\
+                       manager_id = coalesce($4::int, person.manager_id), \n\
+                       department_id = coalesce($5::int, person.department_id), \n\
+                       job_id = coalesce($6::int, person.job_id) \n\
+                       from person as before \n\
+                       where person.id = $1 and before.id = person.id \n\
+                       returning person.*, before.manager_id as previous_manager_id";
+    auto binder = *clientPtr << std::string(sql);
+    binder << personId;
+    if (patch.getFirstName()) binder << patch.getValueOfFirstName(); else binder << nullptr;
+    if (patch.getLastName()) binder << patch.getValueOfLastName(); else binder << nullptr;
+    if (patch.getManagerId()) binder << patch.getValueOfManagerId(); else binder << nullptr;
+    if (patch.getDepartmentId()) binder << patch.getValueOfDepartmentId(); else binder << nullptr;
+    if (patch.getJobId()) binder << patch.getValueOfJobId(); else binder << nullptr;
+    return drogon::orm::internal::SqlAwaiter(std::move(binder));
+}
+
+// Used while the org index is loading, or on instances that never built it:
+// one indexed join on person_closure instead of a walk over the index.
+Task<HttpResponsePtr> subtreeFromClosure(int32_t personId, int depth) {
+    const char *sql = "select person_closure.*, person.* \n\
+                       from person_closure \n\
+                       join person on person.id = person_closure.descendant_id \n\
+                       where person_closure.ancestor_id = $1 \n\
+                       and ($2::int < 0 or person_closure.depth <= $2::int) \n\
+                       order by person_closure.depth, person.id";
+    Result result(nullptr);
+    try {
+        result = co_await drogon::app().getDbClient()->execSqlCoro(sql, personId, depth);
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
+    }
+    if (result.empty()) co_return newErrResponse("resource not found", k404NotFound);
+
+    Json::Value ret{};
+    for (const auto &row : result) {
+        PersonClosure closure{row};
+        Person person{row, static_cast<ssize_t>(PersonClosure::getColumnNumber())};
+        auto item = orgEntryToJson(personToOrgEntry(person));
+        item["depth"] = closure.getValueOfDepth();
+        ret.append(item);
+    }
+    co_return HttpResponse::newHttpJsonResponse(ret);
+}
+
+Task<HttpResponsePtr> chainFromClosure(int32_t personId) {
+    // depth 0 is the person themselves, which tells a root from an unknown id
+    const char *sql = "select person_closure.*, person.* \n\
+                       from person_closure \n\
+                       join person on person.id = person_closure.ancestor_id \n\
+                       where person_closure.descendant_id = $1 \n\
+                       order by person_closure.depth";
+    Result result(nullptr);
+    try {
+        result = co_await drogon::app().getDbClient()->execSqlCoro(sql, personId);
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
+    }
+    if (result.empty()) co_return newErrResponse("resource not found", k404NotFound);
+
+    Json::Value ret{Json::arrayValue};
+    for (const auto &row : result) {
+        PersonClosure closure{row};
+        if (closure.getValueOfDepth() == 0) continue;
+        Person person{row, static_cast<ssize_t>(PersonClosure::getColumnNumber())};
+        ret.append(orgEntryToJson(personToOrgEntry(person)));
+    }
+    co_return HttpResponse::newHttpJsonResponse(ret);
+}
+}  // namespace
+
+Task<HttpResponsePtr> PersonsController::get(HttpRequestPtr req) const {
     LOG_DEBUG << "get";
+    // department names and job titles are part of the body
+    auto etag = drogon::app().getPlugin<TableVersionPlugin>()->etag({TableVersionPlugin::Table::Person, TableVersionPlugin::Table::Department, TableVersionPlugin::Table::Job});
+    if (auto resp = notModifiedResponse(req, etag)) co_return resp;
+    auto *cachePtr = drogon::app().getPlugin<ResponseCachePlugin>();
+    auto cacheKey = ResponseCachePlugin::keyOf(req);
+    if (auto resp = cachePtr->cached(req, cacheKey, etag)) co_return resp;
     auto sort_field = req->getOptionalParameter<std::string>("sort_field").value_or("id");
     auto sort_order = req->getOptionalParameter<std::string>("sort_order").value_or("asc");
-    auto limit = req->getOptionalParameter<int>("limit").value_or(25);
-    auto offset = req->getOptionalParameter<int>("offset").value_or(0);
-
-    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
-    const char *sql = "select person.*, \n\
-                       job.title as job_title, \n\
-                       department.name as department_name, \n\
-                       concat(manager.first_name, ' ', manager.last_name) as manager_full_name \n\
-                       from person \n\
-                       join job on person.job_id =job.id \n\
-                       join department on person.department_id=department.id \n\
-                       join person as manager on person.manager_id = manager.id \n\
-                       order by $sort_field $sort_order \n\
-                       limit $1 offset $2;";
-
-    // hack workaroun
-    auto sql_sub = std::regex_replace(sql, std::regex("\\$sort_field"), sort_field);
-    sql_sub = std::regex_replace(sql_sub, std::regex("\\$sort_order"), sort_order);
-
-    *dbClientPtr << std::string(sql_sub)
-                 << std::to_string(limit)
-                 << std::to_string(offset)
-                 >> [callbackPtr](const Result &result)
-                   {
-                      if (result.empty()) {
-                          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
-                          resp->setStatusCode(HttpStatusCode::k404NotFound);
-                          (*callbackPtr)(resp);
-                          return;
-                      }
-
-                      Json::Value ret{};
-                      for (auto row : result) {
-                          PersonInfo personInfo{row};
-                          PersonDetails personDetails{personInfo};
-                          ret.append(personDetails.toJson());
-                      }
-
-                      auto resp = HttpResponse::newHttpJsonResponse(ret);
-                      resp->setStatusCode(HttpStatusCode::k200OK);
-                      (*callbackPtr)(resp);
-                   }
-                 >> [callbackPtr](const DrogonDbException &e)
-                   {
-                      LOG_ERROR << e.base().what();
-                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-                      (*callbackPtr)(resp);
-                   };
+    auto under = req->getOptionalParameter<int>("under");
+    auto cursorToken = req->getOptionalParameter<std::string>("cursor");
+    auto fieldList = req->getOptionalParameter<std::string>("fields");
+
+    auto fields = fieldList ? parsePersonFields(*fieldList) : kPersonAllFields;
+    if (!fields) co_return newErrResponse("unknown field in fields");
+
+    // one bit per kPersonFilters entry that is present, values in that order
+    unsigned filters = 0;
+    std::array<std::optional<std::string>, kPersonFilterCount> filterValues;
+    for (std::size_t f = 0; f < kPersonFilterCount; ++f) {
+        auto value = req->getOptionalParameter<std::string>(kPersonFilters[f].param);
+        if (!value) continue;
+        const auto &filter = kPersonFilters[f];
+        auto valid = filter.value == FilterValue::Date ? isIsoDate(*value)
+                   : filter.value == FilterValue::IdList ? isIdList(*value)
+                   : isId(*value);
+        if (!valid) co_return newErrResponse(std::string("invalid ") + filter.param);
+        filters |= 1u << f;
+        filterValues[f] = filter.value == FilterValue::IdList ? "{" + *value + "}" : std::move(*value);
+    }
+    // a multi-get returns every id asked for unless told otherwise
+    auto defaultLimit = filters & kIdsFilter
+                      ? static_cast<int>(std::count(filterValues[0]->begin(), filterValues[0]->end(), ',') + 1)
+                      : 25;
+    auto pageLimit = pageLimitOf(req, defaultLimit);
+    auto pageOffset = pageOffsetOf(req);
+    if (!pageLimit || !pageOffset) co_return newErrResponse("limit and offset must not be negative");
+    auto limit = *pageLimit;
+    auto offset = *pageOffset;
+
+    // a cursor carries the sort it was issued for and replaces offset
+    std::optional<PageCursor> cursor;
+    if (cursorToken) {
+        cursor = decodeCursor(*cursorToken);
+        if (!cursor) co_return newErrResponse("invalid cursor");
+        sort_field = cursor->sortField;
+        sort_order = cursor->sortOrder;
+        offset = 0;
+    }
+    if (!kPersonSortColumns.count(sort_field) || (sort_order != "asc" && sort_order != "desc")) {
+        co_return newErrResponse(cursor ? "invalid cursor" : "unknown sort_field or sort_order");
+    }
+
+    Result result(nullptr);
+    try {
+        auto binder = *drogon::app().getDbClient() << kPersonsPageSql.at({sort_field, sort_order, cursor.has_value()});
+        binder << std::to_string(limit);
+        binder << std::to_string(offset);
+        if (under) binder << *under; else binder << nullptr;
+        for (const auto &value : filterValues) {
+            if (value) binder << *value; else binder << nullptr;
+        }
+        if (cursor) {
+            binder << cursor->key;
+            binder << cursor->id;
+        }
+        result = co_await drogon::orm::internal::SqlAwaiter(std::move(binder));
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
+    }
+    if (result.empty()) co_return newErrResponse("resource not found", k404NotFound);
+
+    auto fill = cachePtr->fill(cacheKey, etag);
+    auto resp = newJsonArrayStreamResponse(result.size(), [result, fields = *fields](std::size_t i, std::string &out) {
+        appendJson(out, PersonInfo{result[i]}, fields);
+    }, fill);
+    // the table total only means something for an unfiltered page
+    if (!under && filters == 0) addTotalCountHeader(resp, RowCountPlugin::Table::Person);
+    resp->addHeader("ETag", etag);
+    // a short page is the last one
+    if (result.size() == static_cast<std::size_t>(limit)) {
+        const auto &last = result[result.size() - 1];
+        resp->addHeader("X-Next-Cursor", encodeCursor({
+            sort_field,
+            sort_order,
+            last["id"].as<int32_t>(),
+            last[sort_field].as<std::string>()}));
+    }
+    fill->keepHeaders(resp);
+    co_return resp;
 }
 
-void PersonsController::getOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId) const {
+Task<HttpResponsePtr> PersonsController::getOne(HttpRequestPtr req, int personId) const {
     LOG_DEBUG << "getOne personId: "<< personId;
-    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
-
-    const char *sql = "select person.*, \n\
-                       job.title as job_title, \n\
-                       department.name as department_name, \n\
-                       concat(manager.first_name, ' ', manager.last_name) as manager_full_name \n\
-                       from person \n\
-                       join job on person.job_id =job.id \n\
-                       join department on person.department_id=department.id \n\
-                       join person as manager on person.manager_id = manager.id \n\
-                       where person.id = $1";
-
-    *dbClientPtr << std::string(sql)
-                 << personId
-                 >> [callbackPtr](const Result &result)
-                   {
-                      if (result.empty()) {
-                          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
-                          resp->setStatusCode(HttpStatusCode::k404NotFound);
-                          (*callbackPtr)(resp);
-                          return;
-                      }
-
-                      auto row = result[0];
-                      PersonInfo personInfo{row};
-                      PersonDetails personDetails{personInfo};
-
-                      Json::Value ret = personDetails.toJson();
-                      auto resp = HttpResponse::newHttpJsonResponse(ret);
-                      resp->setStatusCode(HttpStatusCode::k200OK);
-                      (*callbackPtr)(resp);
-                   }
-                 >> [callbackPtr](const DrogonDbException &e)
-                   {
-                      LOG_ERROR << e.base().what();
-                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-                      (*callbackPtr)(resp);
-                   };
+    auto etag = drogon::app().getPlugin<TableVersionPlugin>()->etag({TableVersionPlugin::Table::Person, TableVersionPlugin::Table::Department, TableVersionPlugin::Table::Job});
+    if (auto resp = notModifiedResponse(req, etag)) co_return resp;
+    auto *cachePtr = drogon::app().getPlugin<ResponseCachePlugin>();
+    auto cacheKey = ResponseCachePlugin::keyOf(req);
+    if (auto resp = cachePtr->cached(req, cacheKey, etag)) co_return resp;
+    auto fieldList = req->getOptionalParameter<std::string>("fields");
+    auto fields = fieldList ? parsePersonFields(*fieldList) : kPersonAllFields;
+    if (!fields) co_return newErrResponse("unknown field in fields");
+
+    std::string body;
+    try {
+        auto row = co_await drogon::app().getPlugin<PersonLoaderPlugin>()->load(personsByIdsSql(personJoins(*fields)), personId);
+        if (!row) co_return newErrResponse("resource not found", k404NotFound);
+        appendJson(body, PersonInfo{*row}, *fields);
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
+    }
+
+    auto fill = cachePtr->fill(cacheKey, etag);
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setContentTypeCode(CT_APPLICATION_JSON);
+    resp->addHeader("ETag", etag);
+    fill->keepHeaders(resp);
+    fill->done(body);
+    resp->setBody(std::move(body));
+    co_return resp;
 }
 
-void PersonsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Person &&pPerson) const {
+Task<HttpResponsePtr> PersonsController::createOne(HttpRequestPtr req, Person pPerson) const {
     LOG_DEBUG << "createOne";
-    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
-
-    Mapper<Person> mp(dbClientPtr);
-    mp.insert(
-        pPerson,
-        [callbackPtr](const Person &person) {
-            Json::Value ret{};
-            ret = person.toJson();
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k201Created);
-            (*callbackPtr)(resp);
-        },
-        [callbackPtr](const DrogonDbException &e) {
-            LOG_ERROR << e.base().what();
-            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-            (*callbackPtr)(resp);
-    });
+    Person person;
+    try {
+        auto transPtr = co_await drogon::app().getDbClient()->newTransactionCoro();
+        {
+            // the mapper holds the transaction too; let it go before the commit
+            CoroMapper<Person> mp(transPtr);
+            person = co_await mp.insert(pPerson);
+        }
+        co_await insertIntoClosure(transPtr, person.getValueOfId(), person.getValueOfManagerId());
+        if (!co_await CommitAwaiter(std::move(transPtr))) co_return newErrResponse("database error", k500InternalServerError);
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
+    }
+
+    drogon::app().getPlugin<OrgIndexPlugin>()->personSaved(person);
+    drogon::app().getPlugin<RowCountPlugin>()->added(RowCountPlugin::Table::Person);
+    drogon::app().getPlugin<TableVersionPlugin>()->changed(TableVersionPlugin::Table::Person);
+    auto resp = HttpResponse::newHttpJsonResponse(person.toJson());
+    resp->setStatusCode(HttpStatusCode::k201Created);
+    co_return resp;
 }
 
-void PersonsController::updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId, Person &&pPerson) const {
+Task<HttpResponsePtr> PersonsController::updateOne(HttpRequestPtr req, int personId, Person pPerson) const {
     LOG_DEBUG << "updateOne personId: " << personId;
-    auto dbClientPtr = drogon::app().getDbClient();
+    auto *orgIndexPtr = drogon::app().getPlugin<OrgIndexPlugin>();
+    auto indexReady = orgIndexPtr->isReady();
+    if (pPerson.getManagerId() != nullptr && indexReady) {
+        auto managerId = pPerson.getValueOfManagerId();
+        auto isCycle = orgIndexPtr->read([personId, managerId](const OrgIndex &index) {
+            return index.manages(personId, managerId);
+        });
+        if (isCycle) co_return newErrResponse("manager_id would create a management cycle");
+    }
 
-    // blocking IO
-    Mapper<Person> mp(dbClientPtr);
-    Person person;
+    std::optional<Person> person;
     try {
-        person = mp.findFutureByPrimaryKey(personId).get();
-    } catch (const DrogonDbException & e) {
-        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
-        resp->setStatusCode(HttpStatusCode::k404NotFound);
-        callback(resp);
-        return;
+        auto dbClientPtr = drogon::app().getDbClient();
+        // without a new manager the closure table stays as it is, so the
+        // update runs on its own
+        if (pPerson.getManagerId() == nullptr) {
+            auto result = co_await patchPerson(dbClientPtr, personId, pPerson);
+            if (!result.empty()) person.emplace(result[0]);
+        } else {
+            auto transPtr = co_await dbClientPtr->newTransactionCoro();
+            if (!indexReady) {
+                // the index is still loading, so person_closure says whether
+                // the new manager reports to this person
+                const char *cycleSql = "select 1 from person_closure \n\
+                                        where ancestor_id = $1 and descendant_id = $2 and depth > 0";
+                auto below = co_await transPtr->execSqlCoro(cycleSql, personId, pPerson.getValueOfManagerId());
+                if (!below.empty()) {
+                    transPtr->rollback();
+                    co_return newErrResponse("manager_id would create a management cycle");
+                }
+            }
+            auto result = co_await patchPerson(transPtr, personId, pPerson);
+            if (result.empty()) {
+                transPtr->rollback();
+            } else {
+                person.emplace(result[0]);
+                const auto &previous = result[0]["previous_manager_id"];
+                if (previous.isNull() || previous.as<int32_t>() != person->getValueOfManagerId()) {
+                    co_await moveInClosure(transPtr, {{person->getValueOfId(), person->getValueOfManagerId()}});
+                }
+                if (!co_await CommitAwaiter(std::move(transPtr))) co_return newErrResponse("database error", k500InternalServerError);
+            }
+        }
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
     }
+    if (!person) co_return newErrResponse("resource not found", k404NotFound);
 
-    if (pPerson.getJobId() != nullptr) {
-      person.setJobId(pPerson.getValueOfJobId());
-    }
-    if (pPerson.getManagerId() != nullptr) {
-      person.setManagerId(pPerson.getValueOfManagerId());
+    orgIndexPtr->personSaved(*person);
+    drogon::app().getPlugin<TableVersionPlugin>()->changed(TableVersionPlugin::Table::Person);
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setStatusCode(HttpStatusCode::k204NoContent);
+    co_return resp;
+}
+
+Task<HttpResponsePtr> PersonsController::moveMany(HttpRequestPtr req) const {
+    LOG_DEBUG << "moveMany";
+    // bounds the rows one transaction locks
+    const std::size_t maxMoves = 10000;
+
+    auto jsonPtr = req->getJsonObject();
+    std::string err;
+    auto moves = jsonPtr ? ReorgDraft::movesFromJson(*jsonPtr, err) : std::nullopt;
+    if (!moves || moves->empty() || moves->size() > maxMoves) {
+        co_return newErrResponse(moves ? "between 1 and 10000 moves are accepted" : (jsonPtr ? err : "expected an array of moves"));
     }
-    if (pPerson.getDepartmentId() != nullptr) {
-      person.setDepartmentId(pPerson.getValueOfDepartmentId());
+
+    auto *orgIndexPtr = drogon::app().getPlugin<OrgIndexPlugin>();
+    if (!orgIndexPtr->isReady()) co_return indexLoadingResponse();
+
+    // everything that can be checked without the database, in one pass
+    std::unordered_map<int32_t, int32_t> managers;
+    std::set<int32_t> jobIds;
+    std::set<int32_t> departmentIds;
+    err = orgIndexPtr->read([&moves, &managers, &jobIds, &departmentIds](const OrgIndex &index) -> std::string {
+        std::unordered_map<int32_t, bool> seen;
+        for (const auto &move : *moves) {
+            if (!index.contains(move.id)) return "person " + std::to_string(move.id) + " not found";
+            if (!seen.emplace(move.id, true).second) return "person " + std::to_string(move.id) + " is moved twice";
+            if (move.managerId) {
+                if (*move.managerId != move.id && !index.contains(*move.managerId)) {
+                    return "manager " + std::to_string(*move.managerId) + " not found";
+                }
+                managers.emplace(move.id, *move.managerId);
+            }
+            if (move.jobId) jobIds.insert(*move.jobId);
+            if (move.departmentId) departmentIds.insert(*move.departmentId);
+        }
+        auto cycle = index.findCycle(managers);
+        if (cycle) return "person " + std::to_string(*cycle) + " would end up on a management cycle";
+        return "";
+    });
+    if (!err.empty()) co_return newErrResponse(err);
+
+    std::vector<Person> persons;
+    try {
+        auto transPtr = co_await drogon::app().getDbClient()->newTransactionCoro();
+        // foreign keys would reject these too, this just names them
+        const char *checkSql = "select \n\
+                                array(select unnest($1::int[]) except select id from job) as missing_jobs, \n\
+                                array(select unnest($2::int[]) except select id from department) as missing_departments";
+        auto missing = co_await transPtr->execSqlCoro(checkSql,
+                                                      toPgIntArray(std::vector<int32_t>(jobIds.begin(), jobIds.end())),
+                                                      toPgIntArray(std::vector<int32_t>(departmentIds.begin(), departmentIds.end())));
+        auto missingJobs = missing[0]["missing_jobs"].as<std::string>();
+        auto missingDepartments = missing[0]["missing_departments"].as<std::string>();
+        if (missingJobs != "{}" || missingDepartments != "{}") {
+            transPtr->rollback();
+            co_return newErrResponse(missingJobs != "{}" ? "unknown job ids " + missingJobs
+                                                         : "unknown department ids " + missingDepartments);
+        }
+
+        // one column array per field, so the text is the same for every
+        // batch size and is prepared once per connection
+        const char *updateSql = "update person set \n\
+                                 manager_id = coalesce(v.manager_id, person.manager_id), \n\
+                                 department_id = coalesce(v.department_id, person.department_id), \n\
+                                 job_id = coalesce(v.job_id, person.job_id) \n\
+                                 from unnest($1::int[], $2::int[], $3::int[], $4::int[]) as v(id, manager_id, department_id, job_id) \n\
+                                 where person.id = v.id \n\
+                                 returning person.*";
+        std::vector<int32_t> ids;
+        std::vector<std::optional<int32_t>> managerIds;
+        std::vector<std::optional<int32_t>> newDepartmentIds;
+        std::vector<std::optional<int32_t>> newJobIds;
+        for (const auto &move : *moves) {
+            ids.push_back(move.id);
+            managerIds.push_back(move.managerId);
+            newDepartmentIds.push_back(move.departmentId);
+            newJobIds.push_back(move.jobId);
+        }
+        auto result = co_await transPtr->execSqlCoro(updateSql,
+                                                     toPgIntArray(ids),
+                                                     toPgIntArray(managerIds),
+                                                     toPgIntArray(newDepartmentIds),
+                                                     toPgIntArray(newJobIds));
+        persons.reserve(result.size());
+        for (const auto &row : result) persons.emplace_back(row);
+
+        std::vector<std::pair<int32_t, int32_t>> managerMoves;
+        for (const auto &move : *moves) {
+            if (move.managerId) managerMoves.emplace_back(move.id, *move.managerId);
+        }
+        co_await moveInClosure(transPtr, std::move(managerMoves));
+        // answer once the commit went through, not when the update ran
+        if (!co_await CommitAwaiter(std::move(transPtr))) co_return newErrResponse("database error", k500InternalServerError);
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
     }
-    if (pPerson.getFirstName() != nullptr) {
-      person.setFirstName(pPerson.getValueOfFirstName());
+
+    orgIndexPtr->personsSaved(persons);
+    drogon::app().getPlugin<TableVersionPlugin>()->changed(TableVersionPlugin::Table::Person);
+    Json::Value ret{};
+    ret["updated"] = static_cast<Json::UInt>(persons.size());
+    ret["org_version"] = static_cast<Json::UInt64>(orgIndexPtr->version());
+    co_return HttpResponse::newHttpJsonResponse(ret);
+}
+
+Task<HttpResponsePtr> PersonsController::deleteOne(HttpRequestPtr req, int personId) const {
+    LOG_DEBUG << "deleteOne personId: " << personId;
+    std::size_t count = 0;
+    try {
+        CoroMapper<Person> mp(drogon::app().getDbClient());
+        count = co_await mp.deleteBy(Criteria(Person::Cols::_id, CompareOperator::EQ, personId));
+    } catch (const DrogonDbException &e) {
+        co_return databaseError(e);
     }
-    if (pPerson.getLastName() != nullptr) {
-      person.setLastName(pPerson.getValueOfLastName());
+
+    if (count > 0) {
+        drogon::app().getPlugin<OrgIndexPlugin>()->personDeleted(personId);
+        drogon::app().getPlugin<RowCountPlugin>()->removed(RowCountPlugin::Table::Person, count);
+        drogon::app().getPlugin<TableVersionPlugin>()->changed(TableVersionPlugin::Table::Person);
     }
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setStatusCode(HttpStatusCode::k204NoContent);
+    co_return resp;
+}
 
-    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    mp.update(
-        person,
-        [callbackPtr](const std::size_t count)
-        {
-            auto resp = HttpResponse::newHttpResponse();
-            resp->setStatusCode(HttpStatusCode::k204NoContent);
-            (*callbackPtr)(resp);
-        },
-        [callbackPtr](const DrogonDbException &e)
-        {
-            LOG_ERROR << e.base().what();
-            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-            (*callbackPtr)(resp);
-        }
-    );
+Task<HttpResponsePtr> PersonsController::getDirectReports(HttpRequestPtr req, int personId) const {
+    LOG_DEBUG << "getDirectReports personId: "<< personId;
+    co_return co_await getPersonsOf(std::move(req), RowCountPlugin::Table::Person, Person::tableName, Person::Cols::_manager_id, personId);
 }
 
-void PersonsController::deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId) const {
-    LOG_DEBUG << "deleteOne personId: ";
-    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
-
-    Mapper<Person> mp(dbClientPtr);
-    mp.deleteBy(
-        Criteria(Person::Cols::_id, CompareOperator::EQ, personId),
-        [callbackPtr](const std::size_t count) {
-            auto resp = HttpResponse::newHttpResponse();
-            resp->setStatusCode(HttpStatusCode::k204NoContent);
-            (*callbackPtr)(resp);
-        },
-        [callbackPtr](const DrogonDbException &e) {
-            LOG_ERROR << e.base().what();
-            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-            (*callbackPtr)(resp);
+Task<HttpResponsePtr> PersonsController::getSubtree(HttpRequestPtr req, int personId) const {
+    LOG_DEBUG << "getSubtree personId: "<< personId;
+    auto depth = req->getOptionalParameter<int>("depth").value_or(-1);
+
+    auto *orgIndexPtr = drogon::app().getPlugin<OrgIndexPlugin>();
+    if (!orgIndexPtr->isReady()) co_return co_await subtreeFromClosure(personId, depth);
+
+    // the version is read under the same lock as the body it labels
+    uint64_t version = 0;
+    auto ret = orgIndexPtr->read([personId, depth, &version](const OrgIndex &index) {
+        version = index.version();
+        Json::Value ret{};
+        for (const auto &node : index.subtree(personId, depth)) {
+            auto item = orgEntryToJson(*node.entry);
+            item["depth"] = node.depth;
+            ret.append(item);
+        }
+        return ret;
     });
+    if (ret.empty()) co_return newErrResponse("resource not found", k404NotFound);
+
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->addHeader("X-Org-Version", std::to_string(version));
+    co_return resp;
 }
 
-void PersonsController::getDirectReports(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId) const {
-    LOG_DEBUG << "getDirectReports personId: "<< personId;
-    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
+Task<HttpResponsePtr> PersonsController::getChain(HttpRequestPtr req, int personId) const {
+    LOG_DEBUG << "getChain personId: "<< personId;
+    auto *orgIndexPtr = drogon::app().getPlugin<OrgIndexPlugin>();
+    if (!orgIndexPtr->isReady()) co_return co_await chainFromClosure(personId);
 
-    // blocking IO
-    Mapper<Person> mp(dbClientPtr);
-    Person department;
-    try {
-        department = mp.findFutureByPrimaryKey(personId).get();
-    } catch (const DrogonDbException & e) {
-        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
-        resp->setStatusCode(HttpStatusCode::k404NotFound);
-        callback(resp);
-    }
+    auto found = false;
+    uint64_t version = 0;
+    auto ret = orgIndexPtr->read([personId, &found, &version](const OrgIndex &index) {
+        version = index.version();
+        Json::Value ret{Json::arrayValue};
+        found = index.contains(personId);
+        for (auto managerId : index.chainOf(personId)) {
+            ret.append(orgEntryToJson(*index.find(managerId)));
+        }
+        return ret;
+    });
+    if (!found) co_return newErrResponse("resource not found", k404NotFound);
 
-    department.getPersons(dbClientPtr,
-      [callbackPtr](const std::vector<Person> persons) {
-          if (persons.empty()) {
-             auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
-             resp->setStatusCode(HttpStatusCode::k404NotFound);
-             (*callbackPtr)(resp);
-          } else {
-             Json::Value ret{};
-             for (auto p : persons) {
-                 ret.append(p.toJson());
-             }
-             auto resp = HttpResponse::newHttpJsonResponse(ret);
-             resp->setStatusCode(HttpStatusCode::k200OK);
-             (*callbackPtr)(resp);
-          }
-      },
-      [callbackPtr](const DrogonDbException &e) {
-          LOG_ERROR << e.base().what();
-          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-          resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-          (*callbackPtr)(resp);
-      });
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->addHeader("X-Org-Version", std::to_string(version));
+    co_return resp;
 }
 
-PersonsController::PersonDetails::PersonDetails(const PersonInfo &personInfo) {
-    id = personInfo.getValueOfId();
-    first_name = personInfo.getValueOfFirstName();
-    last_name = personInfo.getValueOfLastName();
-    hire_date = personInfo.getValueOfHireDate();
-    Json::Value managerJson{};
-    managerJson["id"] = personInfo.getValueOfManagerId();
-    managerJson["full_name"] = personInfo.getValueOfManagerFullName();
-    this->manager = managerJson;
-    Json::Value departmentJson{};
-    departmentJson["id"] = personInfo.getValueOfDepartmentId();
-    departmentJson["name"] = personInfo.getValueOfDepartmentName();
-    this->department = departmentJson;
-    Json::Value jobJson{};
-    jobJson["id"] = personInfo.getValueOfJobId();
-    jobJson["title"] = personInfo.getValueOfJobTitle();
-    this->job = jobJson;
+Task<HttpResponsePtr> PersonsController::getCommonManager(HttpRequestPtr req, int personId, int otherPersonId) const {
+    LOG_DEBUG << "getCommonManager personId: "<< personId << " otherPersonId: " << otherPersonId;
+    auto *orgIndexPtr = drogon::app().getPlugin<OrgIndexPlugin>();
+    if (!orgIndexPtr->isReady()) co_return indexLoadingResponse();
+
+    uint64_t version = 0;
+    auto ret = orgIndexPtr->read([personId, otherPersonId, &version](const OrgIndex &index) {
+        version = index.version();
+        auto managerId = index.commonManager(personId, otherPersonId);
+        return managerId ? orgEntryToJson(*index.find(*managerId)) : Json::Value{};
+    });
+    if (ret.isNull()) co_return newErrResponse("resource not found", k404NotFound);
+
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->addHeader("X-Org-Version", std::to_string(version));
+    co_return resp;
 }
 
-auto PersonsController::PersonDetails::toJson() -> Json::Value {
-    Json::Value ret{};
-    ret["id"] = id;
-    ret["first_name"] = first_name;
-    ret["last_name"] = last_name;
-    ret["hire_date"] = hire_date.toDbStringLocal();
-    ret["manager"] = manager;
-    ret["department"] = department;
-    ret["job"] = job;
-    return ret;
+Task<HttpResponsePtr> PersonsController::getStats(HttpRequestPtr req, int personId) const {
+    LOG_DEBUG << "getStats personId: "<< personId;
+    auto *orgIndexPtr = drogon::app().getPlugin<OrgIndexPlugin>();
+    if (!orgIndexPtr->isReady()) co_return indexLoadingResponse();
+
+    uint64_t version = 0;
+    auto ret = orgIndexPtr->read([personId, &version](const OrgIndex &index) {
+        version = index.version();
+        const auto *stats = index.statsOf(personId);
+        if (!stats) return Json::Value{};
+        Json::Value ret{};
+        ret["id"] = personId;
+        ret["direct_reports"] = static_cast<Json::UInt>(index.reportsOf(personId).size());
+        ret["headcount"] = stats->headcount;
+        ret["max_depth_below"] = stats->height;
+        ret["departments"] = countsToJson(stats->departments);
+        ret["jobs"] = countsToJson(stats->jobs);
+        return ret;
+    });
+    if (ret.isNull()) co_return newErrResponse("resource not found", k404NotFound);
+
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->addHeader("X-Org-Version", std::to_string(version));
+    co_return resp;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <drogon/utils/coroutine.h>
 #include <string>
 #include "../models/Person.h"
 #include "../models/PersonInfo.h"
@@ -14,29 +15,25 @@ class PersonsController : public drogon::HttpController<PersonsController> {
       ADD_METHOD_TO(PersonsController::get, "/persons", Get);
       ADD_METHOD_TO(PersonsController::getOne, "/persons/{1}", Get);
       ADD_METHOD_TO(PersonsController::createOne, "/persons", Post);
+      ADD_METHOD_TO(PersonsController::moveMany, "/persons:move", Post);
       ADD_METHOD_TO(PersonsController::updateOne, "/persons/{1}", Put);
       ADD_METHOD_TO(PersonsController::deleteOne, "/persons/{1}", Delete);
       ADD_METHOD_TO(PersonsController::getDirectReports, "/persons/{1}/reports", Get);
+      ADD_METHOD_TO(PersonsController::getSubtree, "/persons/{1}/subtree", Get);
+      ADD_METHOD_TO(PersonsController::getChain, "/persons/{1}/chain", Get);
+      ADD_METHOD_TO(PersonsController::getCommonManager, "/persons/{1}/common-manager/{2}", Get);
+      ADD_METHOD_TO(PersonsController::getStats, "/persons/{1}/stats", Get);
     METHOD_LIST_END
 
-    void get(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback) const;
-    void getOne(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
-    void createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Person &&pPerson) const;
-    void updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId, Person &&pPerson) const;
-    void deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
-    void getDirectReports(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
-
- private:
-    struct PersonDetails {
-        int id;
-        std::string first_name;
-        std::string last_name;
-        trantor::Date hire_date;
-        Json::Value manager;
-        Json::Value department;
-        Json::Value job;
-        PersonDetails() {}
-        explicit PersonDetails(const PersonInfo &personInfo);
-        Json::Value toJson();
-    };
+    Task<HttpResponsePtr> get(HttpRequestPtr req) const;
+    Task<HttpResponsePtr> getOne(HttpRequestPtr req, int pPersonId) const;
+    Task<HttpResponsePtr> createOne(HttpRequestPtr req, Person pPerson) const;
+    Task<HttpResponsePtr> updateOne(HttpRequestPtr req, int pPersonId, Person pPerson) const;
+    Task<HttpResponsePtr> moveMany(HttpRequestPtr req) const;
+    Task<HttpResponsePtr> deleteOne(HttpRequestPtr req, int pPersonId) const;
+    Task<HttpResponsePtr> getDirectReports(HttpRequestPtr req, int pPersonId) const;
+    Task<HttpResponsePtr> getSubtree(HttpRequestPtr req, int pPersonId) const;
+    Task<HttpResponsePtr> getChain(HttpRequestPtr req, int pPersonId) const;
+    Task<HttpResponsePtr> getCommonManager(HttpRequestPtr req, int pPersonId, int pOtherPersonId) const;
+    Task<HttpResponsePtr> getStats(HttpRequestPtr req, int pPersonId) const;
 };
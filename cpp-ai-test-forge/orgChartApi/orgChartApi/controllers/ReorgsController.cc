@@ -0,0 +1,193 @@
+#include "ReorgsController.h"
+#include "../plugins/ReorgPlugin.h"
+#include "../utils/utils.h"
+#include <string>
+#include <vector>
+
+namespace {
+void notFound(const std::function<void(const HttpResponsePtr &)> &callback) {
+    auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+    resp->setStatusCode(HttpStatusCode::k404NotFound);
+    callback(resp);
+}
+
+void stale(const std::function<void(const HttpResponsePtr &)> &callback) {
+    auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("the org changed since this draft was opened, rebase it"));
+    resp->setStatusCode(HttpStatusCode::k409Conflict);
+    callback(resp);
+}
+}  // namespace
+
+void ReorgsController::get(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
+    LOG_DEBUG << "get";
+    auto *reorgPtr = drogon::app().getPlugin<ReorgPlugin>();
+    Json::Value ret{Json::arrayValue};
+    for (auto draftId : reorgPtr->ids()) {
+        reorgPtr->with(draftId, [&ret, draftId](ReorgDraft &draft, const OrgIndex &base) {
+            ret.append(draftToJson(draftId, draft, base));
+        });
+    }
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->setStatusCode(HttpStatusCode::k200OK);
+    callback(resp);
+}
+
+void ReorgsController::getOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int draftId) const {
+    LOG_DEBUG << "getOne draftId: " << draftId;
+    Json::Value ret{};
+    auto found = drogon::app().getPlugin<ReorgPlugin>()->with(draftId, [&ret, draftId](ReorgDraft &draft, const OrgIndex &base) {
+        ret = draftToJson(draftId, draft, base);
+    });
+    if (!found) {
+        notFound(callback);
+        return;
+    }
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->setStatusCode(HttpStatusCode::k200OK);
+    callback(resp);
+}
+
+void ReorgsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
+    LOG_DEBUG << "createOne";
+    if (!drogon::app().getPlugin<OrgIndexPlugin>()->isReady()) {
+        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("org index is loading"));
+        resp->setStatusCode(HttpStatusCode::k503ServiceUnavailable);
+        callback(resp);
+        return;
+    }
+
+    auto *reorgPtr = drogon::app().getPlugin<ReorgPlugin>();
+    auto draftId = reorgPtr->open();
+    if (!draftId) {
+        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("too many open drafts"));
+        resp->setStatusCode(HttpStatusCode::k429TooManyRequests);
+        callback(resp);
+        return;
+    }
+
+    Json::Value ret{};
+    reorgPtr->with(*draftId, [&ret, draftId](ReorgDraft &draft, const OrgIndex &base) {
+        ret = draftToJson(*draftId, draft, base);
+    });
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->setStatusCode(HttpStatusCode::k201Created);
+    callback(resp);
+}
+
+void ReorgsController::deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int draftId) const {
+    LOG_DEBUG << "deleteOne draftId: " << draftId;
+    if (!drogon::app().getPlugin<ReorgPlugin>()->close(draftId)) {
+        notFound(callback);
+        return;
+    }
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setStatusCode(HttpStatusCode::k204NoContent);
+    callback(resp);
+}
+
+void ReorgsController::applyMoves(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int draftId) const {
+    LOG_DEBUG << "applyMoves draftId: " << draftId;
+    auto jsonPtr = req->getJsonObject();
+    std::string err;
+    auto moves = jsonPtr ? ReorgDraft::movesFromJson(*jsonPtr, err) : std::nullopt;
+    if (!moves) {
+        badRequest(std::move(callback), jsonPtr ? err : "expected an array of moves");
+        return;
+    }
+
+    Json::Value ret{};
+    auto isStale = false;
+    auto found = drogon::app().getPlugin<ReorgPlugin>()->with(draftId, [&](ReorgDraft &draft, const OrgIndex &base) {
+        isStale = draft.isStale(base);
+        if (isStale || !draft.apply(base, *moves, err)) return;
+        ret = draftToJson(draftId, draft, base);
+    });
+    if (!found) {
+        notFound(callback);
+        return;
+    }
+    if (isStale) {
+        stale(callback);
+        return;
+    }
+    if (!err.empty()) {
+        badRequest(std::move(callback), err);
+        return;
+    }
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->setStatusCode(HttpStatusCode::k200OK);
+    callback(resp);
+}
+
+void ReorgsController::rebase(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int draftId) const {
+    LOG_DEBUG << "rebase draftId: " << draftId;
+    Json::Value ret{};
+    auto found = drogon::app().getPlugin<ReorgPlugin>()->with(draftId, [&ret, draftId](ReorgDraft &draft, const OrgIndex &base) {
+        auto dropped = draft.rebase(base);
+        ret = draftToJson(draftId, draft, base);
+        ret["dropped_moves"] = Json::Value{Json::arrayValue};
+        for (const auto &move : dropped) ret["dropped_moves"].append(moveToJson(move));
+    });
+    if (!found) {
+        notFound(callback);
+        return;
+    }
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->setStatusCode(HttpStatusCode::k200OK);
+    callback(resp);
+}
+
+void ReorgsController::getPerson(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int draftId, int personId) const {
+    LOG_DEBUG << "getPerson draftId: " << draftId << " personId: " << personId;
+    Json::Value ret{};
+    auto isStale = false;
+    auto found = drogon::app().getPlugin<ReorgPlugin>()->with(draftId, [&](ReorgDraft &draft, const OrgIndex &base) {
+        isStale = draft.isStale(base);
+        if (isStale) return;
+        auto view = draft.view(base, personId);
+        if (!view) return;
+        ret["id"] = view->id;
+        ret["manager_id"] = view->managerId;
+        ret["department_id"] = view->departmentId;
+        ret["job_id"] = view->jobId;
+        ret["depth"] = view->depth;
+        ret["reports"] = Json::Value{Json::arrayValue};
+        for (auto report : view->reports) ret["reports"].append(report);
+        ret["direct_reports"] = static_cast<Json::UInt>(view->reports.size());
+        ret["headcount"] = view->stats.headcount;
+        ret["max_depth_below"] = view->stats.height;
+        ret["departments"] = countsToJson(view->stats.departments);
+        ret["jobs"] = countsToJson(view->stats.jobs);
+    });
+    if (isStale) {
+        stale(callback);
+        return;
+    }
+    if (!found || ret.isNull()) {
+        notFound(callback);
+        return;
+    }
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->setStatusCode(HttpStatusCode::k200OK);
+    callback(resp);
+}
+
+Json::Value ReorgsController::draftToJson(int draftId, const ReorgDraft &draft, const OrgIndex &base) {
+    Json::Value ret{};
+    ret["id"] = draftId;
+    ret["base_version"] = static_cast<Json::UInt64>(draft.baseVersion());
+    ret["org_version"] = static_cast<Json::UInt64>(base.version());
+    ret["stale"] = draft.isStale(base);
+    ret["moves"] = Json::Value{Json::arrayValue};
+    for (const auto &move : draft.moves()) ret["moves"].append(moveToJson(move));
+    return ret;
+}
+
+Json::Value ReorgsController::moveToJson(const ReorgDraft::Move &move) {
+    Json::Value ret{};
+    ret["id"] = move.id;
+    if (move.managerId) ret["manager_id"] = *move.managerId;
+    if (move.departmentId) ret["department_id"] = *move.departmentId;
+    if (move.jobId) ret["job_id"] = *move.jobId;
+    return ret;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <drogon/HttpController.h>
+#include "../plugins/ReorgDraft.h"
+
+using namespace drogon;
+
+class ReorgsController : public drogon::HttpController<ReorgsController> {
+ public:
+    METHOD_LIST_BEGIN
+      ADD_METHOD_TO(ReorgsController::get, "/reorgs", Get, "LoginFilter");
+      ADD_METHOD_TO(ReorgsController::getOne, "/reorgs/{1}", Get, "LoginFilter");
+      ADD_METHOD_TO(ReorgsController::createOne, "/reorgs", Post, "LoginFilter");
+      ADD_METHOD_TO(ReorgsController::deleteOne, "/reorgs/{1}", Delete, "LoginFilter");
+      ADD_METHOD_TO(ReorgsController::applyMoves, "/reorgs/{1}/moves", Post, "LoginFilter");
+      ADD_METHOD_TO(ReorgsController::rebase, "/reorgs/{1}/rebase", Post, "LoginFilter");
+      ADD_METHOD_TO(ReorgsController::getPerson, "/reorgs/{1}/persons/{2}", Get, "LoginFilter");
+    METHOD_LIST_END
+
+    void get(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const;
+    void getOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pDraftId) const;
+    void createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const;
+    void deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pDraftId) const;
+    void applyMoves(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pDraftId) const;
+    void rebase(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pDraftId) const;
+    void getPerson(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pDraftId, int pPersonId) const;
+
+ private:
+    static Json::Value draftToJson(int draftId, const ReorgDraft &draft, const OrgIndex &base);
+    static Json::Value moveToJson(const ReorgDraft::Move &move);
+};
@@ -0,0 +1,669 @@
+/**
+ *
+ *  PersonClosure.cc
+ *  DO NOT EDIT. This file is generated by drogon_ctl
+ *
+ */
+
+#include "PersonClosure.h"
+#include <drogon/utils/Utilities.h>
+#include <string>
+
+using namespace drogon;
+using namespace drogon::orm;
+using namespace drogon_model::org_chart;
+
+const std::string PersonClosure::Cols::_ancestor_id = "ancestor_id";
+const std::string PersonClosure::Cols::_descendant_id = "descendant_id";
+const std::string PersonClosure::Cols::_depth = "depth";
+const std::vector<std::string> PersonClosure::primaryKeyName = {"ancestor_id","descendant_id"};
+const bool PersonClosure::hasPrimaryKey = true;
+const std::string PersonClosure::tableName = "person_closure";
+
+const std::vector<typename PersonClosure::MetaData> PersonClosure::metaData_={
+{"ancestor_id","int32_t","integer",4,0,1,1},
+{"descendant_id","int32_t","integer",4,0,1,1},
+{"depth","int32_t","integer",4,0,0,1}
+};
+const std::string &PersonClosure::getColumnName(size_t index) noexcept(false)
+{
+    assert(index < metaData_.size());
+    return metaData_[index].colName_;
+}
+PersonClosure::PersonClosure(const Row &r, const ssize_t indexOffset) noexcept
+{
+    if(indexOffset < 0)
+    {
+        if(!r["ancestor_id"].isNull())
+        {
+            ancestorId_=std::make_shared<int32_t>(r["ancestor_id"].as<int32_t>());
+        }
+        if(!r["descendant_id"].isNull())
+        {
+            descendantId_=std::make_shared<int32_t>(r["descendant_id"].as<int32_t>());
+        }
+        if(!r["depth"].isNull())
+        {
+            depth_=std::make_shared<int32_t>(r["depth"].as<int32_t>());
+        }
+    }
+    else
+    {
+        size_t offset = (size_t)indexOffset;
+        if(offset + 3 > r.size())
+        {
+            LOG_FATAL << "Invalid SQL result for this model";
+            return;
+        }
+        size_t index;
+        index = offset + 0;
+        if(!r[index].isNull())
+        {
+            ancestorId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+        }
+        index = offset + 1;
+        if(!r[index].isNull())
+        {
+            descendantId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+        }
+        index = offset + 2;
+        if(!r[index].isNull())
+        {
+            depth_=std::make_shared<int32_t>(r[index].as<int32_t>());
+        }
+    }
+
+}
+
+PersonClosure::PersonClosure(const Json::Value &pJson, const std::vector<std::string> &pMasqueradingVector) noexcept(false)
+{
+    if(pMasqueradingVector.size() != 3)
+    {
+        LOG_ERROR << "Bad masquerading vector";
+        return;
+    }
+    if(!pMasqueradingVector[0].empty() && pJson.isMember(pMasqueradingVector[0]))
+    {
+        dirtyFlag_[0] = true;
+        if(!pJson[pMasqueradingVector[0]].isNull())
+        {
+            ancestorId_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+        }
+    }
+    if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
+    {
+        dirtyFlag_[1] = true;
+        if(!pJson[pMasqueradingVector[1]].isNull())
+        {
+            descendantId_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[1]].asInt64());
+        }
+    }
+    if(!pMasqueradingVector[2].empty() && pJson.isMember(pMasqueradingVector[2]))
+    {
+        dirtyFlag_[2] = true;
+        if(!pJson[pMasqueradingVector[2]].isNull())
+        {
+            depth_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[2]].asInt64());
+        }
+    }
+}
+
+PersonClosure::PersonClosure(const Json::Value &pJson) noexcept(false)
+{
+    if(pJson.isMember("ancestor_id"))
+    {
+        dirtyFlag_[0]=true;
+        if(!pJson["ancestor_id"].isNull())
+        {
+            ancestorId_=std::make_shared<int32_t>((int32_t)pJson["ancestor_id"].asInt64());
+        }
+    }
+    if(pJson.isMember("descendant_id"))
+    {
+        dirtyFlag_[1]=true;
+        if(!pJson["descendant_id"].isNull())
+        {
+            descendantId_=std::make_shared<int32_t>((int32_t)pJson["descendant_id"].asInt64());
+        }
+    }
+    if(pJson.isMember("depth"))
+    {
+        dirtyFlag_[2]=true;
+        if(!pJson["depth"].isNull())
+        {
+            depth_=std::make_shared<int32_t>((int32_t)pJson["depth"].asInt64());
+        }
+    }
+}
+
+void PersonClosure::updateByMasqueradedJson(const Json::Value &pJson,
+                                            const std::vector<std::string> &pMasqueradingVector) noexcept(false)
+{
+    if(pMasqueradingVector.size() != 3)
+    {
+        LOG_ERROR << "Bad masquerading vector";
+        return;
+    }
+    if(!pMasqueradingVector[0].empty() && pJson.isMember(pMasqueradingVector[0]))
+    {
+        if(!pJson[pMasqueradingVector[0]].isNull())
+        {
+            ancestorId_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+        }
+    }
+    if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
+    {
+        if(!pJson[pMasqueradingVector[1]].isNull())
+        {
+            descendantId_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[1]].asInt64());
+        }
+    }
+    if(!pMasqueradingVector[2].empty() && pJson.isMember(pMasqueradingVector[2]))
+    {
+        dirtyFlag_[2] = true;
+        if(!pJson[pMasqueradingVector[2]].isNull())
+        {
+            depth_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[2]].asInt64());
+        }
+    }
+}
+
+void PersonClosure::updateByJson(const Json::Value &pJson) noexcept(false)
+{
+    if(pJson.isMember("ancestor_id"))
+    {
+        if(!pJson["ancestor_id"].isNull())
+        {
+            ancestorId_=std::make_shared<int32_t>((int32_t)pJson["ancestor_id"].asInt64());
+        }
+    }
+    if(pJson.isMember("descendant_id"))
+    {
+        if(!pJson["descendant_id"].isNull())
+        {
+            descendantId_=std::make_shared<int32_t>((int32_t)pJson["descendant_id"].asInt64());
+        }
+    }
+    if(pJson.isMember("depth"))
+    {
+        dirtyFlag_[2] = true;
+        if(!pJson["depth"].isNull())
+        {
+            depth_=std::make_shared<int32_t>((int32_t)pJson["depth"].asInt64());
+        }
+    }
+}
+
+const int32_t &PersonClosure::getValueOfAncestorId() const noexcept
+{
+    const static int32_t defaultValue = int32_t();
+    if(ancestorId_)
+        return *ancestorId_;
+    return defaultValue;
+}
+const std::shared_ptr<int32_t> &PersonClosure::getAncestorId() const noexcept
+{
+    return ancestorId_;
+}
+void PersonClosure::setAncestorId(const int32_t &pAncestorId) noexcept
+{
+    ancestorId_ = std::make_shared<int32_t>(pAncestorId);
+    dirtyFlag_[0] = true;
+}
+
+const int32_t &PersonClosure::getValueOfDescendantId() const noexcept
+{
+    const static int32_t defaultValue = int32_t();
+    if(descendantId_)
+        return *descendantId_;
+    return defaultValue;
+}
+const std::shared_ptr<int32_t> &PersonClosure::getDescendantId() const noexcept
+{
+    return descendantId_;
+}
+void PersonClosure::setDescendantId(const int32_t &pDescendantId) noexcept
+{
+    descendantId_ = std::make_shared<int32_t>(pDescendantId);
+    dirtyFlag_[1] = true;
+}
+
+const int32_t &PersonClosure::getValueOfDepth() const noexcept
+{
+    const static int32_t defaultValue = int32_t();
+    if(depth_)
+        return *depth_;
+    return defaultValue;
+}
+const std::shared_ptr<int32_t> &PersonClosure::getDepth() const noexcept
+{
+    return depth_;
+}
+void PersonClosure::setDepth(const int32_t &pDepth) noexcept
+{
+    depth_ = std::make_shared<int32_t>(pDepth);
+    dirtyFlag_[2] = true;
+}
+
+void PersonClosure::updateId(const uint64_t id)
+{
+}
+typename PersonClosure::PrimaryKeyType PersonClosure::getPrimaryKey() const
+{
+    return std::make_tuple(*ancestorId_,*descendantId_);
+}
+
+const std::vector<std::string> &PersonClosure::insertColumns() noexcept
+{
+    static const std::vector<std::string> inCols={
+        "ancestor_id",
+        "descendant_id",
+        "depth"
+    };
+    return inCols;
+}
+
+void PersonClosure::outputArgs(drogon::orm::internal::SqlBinder &binder) const
+{
+    if(dirtyFlag_[0])
+    {
+        if(getAncestorId())
+        {
+            binder << getValueOfAncestorId();
+        }
+        else
+        {
+            binder << nullptr;
+        }
+    }
+    if(dirtyFlag_[1])
+    {
+        if(getDescendantId())
+        {
+            binder << getValueOfDescendantId();
+        }
+        else
+        {
+            binder << nullptr;
+        }
+    }
+    if(dirtyFlag_[2])
+    {
+        if(getDepth())
+        {
+            binder << getValueOfDepth();
+        }
+        else
+        {
+            binder << nullptr;
+        }
+    }
+}
+
+const std::vector<std::string> PersonClosure::updateColumns() const
+{
+    std::vector<std::string> ret;
+    if(dirtyFlag_[0])
+    {
+        ret.push_back(getColumnName(0));
+    }
+    if(dirtyFlag_[1])
+    {
+        ret.push_back(getColumnName(1));
+    }
+    if(dirtyFlag_[2])
+    {
+        ret.push_back(getColumnName(2));
+    }
+    return ret;
+}
+
+void PersonClosure::updateArgs(drogon::orm::internal::SqlBinder &binder) const
+{
+    if(dirtyFlag_[0])
+    {
+        if(getAncestorId())
+        {
+            binder << getValueOfAncestorId();
+        }
+        else
+        {
+            binder << nullptr;
+        }
+    }
+    if(dirtyFlag_[1])
+    {
+        if(getDescendantId())
+        {
+            binder << getValueOfDescendantId();
+        }
+        else
+        {
+            binder << nullptr;
+        }
+    }
+    if(dirtyFlag_[2])
+    {
+        if(getDepth())
+        {
+            binder << getValueOfDepth();
+        }
+        else
+        {
+            binder << nullptr;
+        }
+    }
+}
+Json::Value PersonClosure::toJson() const
+{
+    Json::Value ret;
+    if(getAncestorId())
+    {
+        ret["ancestor_id"]=getValueOfAncestorId();
+    }
+    else
+    {
+        ret["ancestor_id"]=Json::Value();
+    }
+    if(getDescendantId())
+    {
+        ret["descendant_id"]=getValueOfDescendantId();
+    }
+    else
+    {
+        ret["descendant_id"]=Json::Value();
+    }
+    if(getDepth())
+    {
+        ret["depth"]=getValueOfDepth();
+    }
+    else
+    {
+        ret["depth"]=Json::Value();
+    }
+    return ret;
+}
+
+Json::Value PersonClosure::toMasqueradedJson(
+    const std::vector<std::string> &pMasqueradingVector) const
+{
+    Json::Value ret;
+    if(pMasqueradingVector.size() == 3)
+    {
+        if(!pMasqueradingVector[0].empty())
+        {
+            if(getAncestorId())
+            {
+                ret[pMasqueradingVector[0]]=getValueOfAncestorId();
+            }
+            else
+            {
+                ret[pMasqueradingVector[0]]=Json::Value();
+            }
+        }
+        if(!pMasqueradingVector[1].empty())
+        {
+            if(getDescendantId())
+            {
+                ret[pMasqueradingVector[1]]=getValueOfDescendantId();
+            }
+            else
+            {
+                ret[pMasqueradingVector[1]]=Json::Value();
+            }
+        }
+        if(!pMasqueradingVector[2].empty())
+        {
+            if(getDepth())
+            {
+                ret[pMasqueradingVector[2]]=getValueOfDepth();
+            }
+            else
+            {
+                ret[pMasqueradingVector[2]]=Json::Value();
+            }
+        }
+        return ret;
+    }
+    LOG_ERROR << "Masquerade failed";
+    if(getAncestorId())
+    {
+        ret["ancestor_id"]=getValueOfAncestorId();
+    }
+    else
+    {
+        ret["ancestor_id"]=Json::Value();
+    }
+    if(getDescendantId())
+    {
+        ret["descendant_id"]=getValueOfDescendantId();
+    }
+    else
+    {
+        ret["descendant_id"]=Json::Value();
+    }
+    if(getDepth())
+    {
+        ret["depth"]=getValueOfDepth();
+    }
+    else
+    {
+        ret["depth"]=Json::Value();
+    }
+    return ret;
+}
+
+bool PersonClosure::validateJsonForCreation(const Json::Value &pJson, std::string &err)
+{
+    if(pJson.isMember("ancestor_id"))
+    {
+        if(!validJsonOfField(0, "ancestor_id", pJson["ancestor_id"], err, true))
+            return false;
+    }
+    else
+    {
+        err="The ancestor_id column cannot be null";
+        return false;
+    }
+    if(pJson.isMember("descendant_id"))
+    {
+        if(!validJsonOfField(1, "descendant_id", pJson["descendant_id"], err, true))
+            return false;
+    }
+    else
+    {
+        err="The descendant_id column cannot be null";
+        return false;
+    }
+    if(pJson.isMember("depth"))
+    {
+        if(!validJsonOfField(2, "depth", pJson["depth"], err, true))
+            return false;
+    }
+    else
+    {
+        err="The depth column cannot be null";
+        return false;
+    }
+    return true;
+}
+bool PersonClosure::validateMasqueradedJsonForCreation(const Json::Value &pJson,
+                                                    const std::vector<std::string> &pMasqueradingVector,
+                                                    std::string &err)
+{
+    if(pMasqueradingVector.size() != 3)
+    {
+        err = "Bad masquerading vector";
+        return false;
+    }
+    try {
+      if(!pMasqueradingVector[0].empty())
+      {
+          if(pJson.isMember(pMasqueradingVector[0]))
+          {
+              if(!validJsonOfField(0, pMasqueradingVector[0], pJson[pMasqueradingVector[0]], err, true))
+                  return false;
+          }
+        else
+        {
+            err="The " + pMasqueradingVector[0] + " column cannot be null";
+            return false;
+        }
+      }
+      if(!pMasqueradingVector[1].empty())
+      {
+          if(pJson.isMember(pMasqueradingVector[1]))
+          {
+              if(!validJsonOfField(1, pMasqueradingVector[1], pJson[pMasqueradingVector[1]], err, true))
+                  return false;
+          }
+        else
+        {
+            err="The " + pMasqueradingVector[1] + " column cannot be null";
+            return false;
+        }
+      }
+      if(!pMasqueradingVector[2].empty())
+      {
+          if(pJson.isMember(pMasqueradingVector[2]))
+          {
+              if(!validJsonOfField(2, pMasqueradingVector[2], pJson[pMasqueradingVector[2]], err, true))
+                  return false;
+          }
+        else
+        {
+            err="The " + pMasqueradingVector[2] + " column cannot be null";
+            return false;
+        }
+      }
+    }
+    catch(const Json::LogicError &e)
+    {
+      err = e.what();
+      return false;
+    }
+    return true;
+}
+bool PersonClosure::validateJsonForUpdate(const Json::Value &pJson, std::string &err)
+{
+    if(pJson.isMember("ancestor_id"))
+    {
+        if(!validJsonOfField(0, "ancestor_id", pJson["ancestor_id"], err, false))
+            return false;
+    }
+    else
+    {
+        err = "The value of primary key must be set in the json object for update";
+        return false;
+    }
+    if(pJson.isMember("descendant_id"))
+    {
+        if(!validJsonOfField(1, "descendant_id", pJson["descendant_id"], err, false))
+            return false;
+    }
+    else
+    {
+        err = "The value of primary key must be set in the json object for update";
+        return false;
+    }
+    if(pJson.isMember("depth"))
+    {
+        if(!validJsonOfField(2, "depth", pJson["depth"], err, false))
+            return false;
+    }
+    return true;
+}
+bool PersonClosure::validateMasqueradedJsonForUpdate(const Json::Value &pJson,
+                                                  const std::vector<std::string> &pMasqueradingVector,
+                                                  std::string &err)
+{
+    if(pMasqueradingVector.size() != 3)
+    {
+        err = "Bad masquerading vector";
+        return false;
+    }
+    try {
+      if(!pMasqueradingVector[0].empty() && pJson.isMember(pMasqueradingVector[0]))
+      {
+          if(!validJsonOfField(0, pMasqueradingVector[0], pJson[pMasqueradingVector[0]], err, false))
+              return false;
+      }
+    else
+    {
+        err = "The value of primary key must be set in the json object for update";
+        return false;
+    }
+      if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
+      {
+          if(!validJsonOfField(1, pMasqueradingVector[1], pJson[pMasqueradingVector[1]], err, false))
+              return false;
+      }
+    else
+    {
+        err = "The value of primary key must be set in the json object for update";
+        return false;
+    }
+      if(!pMasqueradingVector[2].empty() && pJson.isMember(pMasqueradingVector[2]))
+      {
+          if(!validJsonOfField(2, pMasqueradingVector[2], pJson[pMasqueradingVector[2]], err, false))
+              return false;
+      }
+    }
+    catch(const Json::LogicError &e)
+    {
+      err = e.what();
+      return false;
+    }
+    return true;
+}
+bool PersonClosure::validJsonOfField(size_t index,
+                                  const std::string &fieldName,
+                                  const Json::Value &pJson,
+                                  std::string &err,
+                                  bool isForCreation)
+{
+    switch(index)
+    {
+        case 0:
+            if(pJson.isNull())
+            {
+                err="The " + fieldName + " column cannot be null";
+                return false;
+            }
+            if(!pJson.isInt())
+            {
+                err="Type error in the "+fieldName+" field";
+                return false;
+            }
+            break;
+        case 1:
+            if(pJson.isNull())
+            {
+                err="The " + fieldName + " column cannot be null";
+                return false;
+            }
+            if(!pJson.isInt())
+            {
+                err="Type error in the "+fieldName+" field";
+                return false;
+            }
+            break;
+        case 2:
+            if(pJson.isNull())
+            {
+                err="The " + fieldName + " column cannot be null";
+                return false;
+            }
+            if(!pJson.isInt())
+            {
+                err="Type error in the "+fieldName+" field";
+                return false;
+            }
+            break;
+        default:
+            err="Internal error in the server";
+            return false;
+            break;
+    }
+    return true;
+}
@@ -0,0 +1,133 @@
+#include "OrgChartWriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace {
+// svg geometry, in pixels per layout unit
+constexpr double kColumn = 160;
+constexpr double kRow = 100;
+constexpr double kBoxWidth = 140;
+constexpr double kBoxHeight = 48;
+constexpr double kMargin = 20;
+
+void appendNumber(std::string &out, double value) {
+    char buf[32];
+    auto len = std::snprintf(buf, sizeof(buf), "%.1f", value);
+    out.append(buf, static_cast<std::size_t>(len));
+}
+
+void appendXmlEscaped(std::string &out, const std::string &text) {
+    for (auto c : text) {
+        switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            case '\'': out += "&apos;"; break;
+            default: out += c;
+        }
+    }
+}
+
+void appendDotEscaped(std::string &out, const std::string &text) {
+    for (auto c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+}
+
+auto boxLeft(const OrgLayout::Node &node) -> double { return kMargin + node.x * kColumn; }
+auto boxTop(const OrgLayout::Node &node) -> double { return kMargin + node.y * kRow; }
+}  // namespace
+
+OrgChartWriter::OrgChartWriter(std::shared_ptr<const OrgLayout> layout, Format format)
+    : layout_(std::move(layout)), format_(format) {}
+
+auto OrgChartWriter::read(char *buf, std::size_t len) -> std::size_t {
+    std::size_t written = 0;
+    while (written < len) {
+        if (pendingPos_ == pending_.size()) {
+            pending_.clear();
+            pendingPos_ = 0;
+            if (stage_ == Stage::Done) break;
+            if (stage_ == Stage::Header) {
+                writeHeader();
+                stage_ = Stage::Nodes;
+            } else if (stage_ == Stage::Nodes && next_ < layout_->nodes.size()) {
+                writeNode(layout_->nodes[next_++]);
+            } else {
+                writeFooter();
+                stage_ = Stage::Done;
+            }
+        }
+        auto count = std::min(len - written, pending_.size() - pendingPos_);
+        std::memcpy(buf + written, pending_.data() + pendingPos_, count);
+        pendingPos_ += count;
+        written += count;
+    }
+    return written;
+}
+
+void OrgChartWriter::writeHeader() {
+    if (format_ == Format::Dot) {
+        pending_ += "digraph org {\n  node [shape=box];\n";
+        return;
+    }
+    pending_ += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"";
+    appendNumber(pending_, 2 * kMargin + layout_->width * kColumn + kBoxWidth);
+    pending_ += "\" height=\"";
+    appendNumber(pending_, 2 * kMargin + layout_->height * kRow + kBoxHeight);
+    pending_ += "\" font-family=\"sans-serif\" font-size=\"12\">\n";
+}
+
+void OrgChartWriter::writeNode(const OrgLayout::Node &node) {
+    if (format_ == Format::Dot) {
+        pending_ += "  n" + std::to_string(node.id) + " [label=\"";
+        appendDotEscaped(pending_, node.firstName + " " + node.lastName);
+        pending_ += "\"];\n";
+        if (node.parent >= 0) {
+            pending_ += "  n" + std::to_string(node.managerId) + " -> n" + std::to_string(node.id) + ";\n";
+        }
+        return;
+    }
+
+    auto left = boxLeft(node);
+    auto top = boxTop(node);
+    if (node.parent >= 0) {
+        // elbow from the bottom of the manager's box to the top of this one
+        const auto &manager = layout_->nodes[node.parent];
+        auto elbow = top - (kRow - kBoxHeight) / 2;
+        pending_ += "<path fill=\"none\" stroke=\"#888\" d=\"M";
+        appendNumber(pending_, boxLeft(manager) + kBoxWidth / 2);
+        pending_ += ' ';
+        appendNumber(pending_, boxTop(manager) + kBoxHeight);
+        pending_ += 'V';
+        appendNumber(pending_, elbow);
+        pending_ += 'H';
+        appendNumber(pending_, left + kBoxWidth / 2);
+        pending_ += 'V';
+        appendNumber(pending_, top);
+        pending_ += "\"/>\n";
+    }
+    pending_ += "<g id=\"p" + std::to_string(node.id) + "\"><rect fill=\"#fff\" stroke=\"#333\" x=\"";
+    appendNumber(pending_, left);
+    pending_ += "\" y=\"";
+    appendNumber(pending_, top);
+    pending_ += "\" width=\"";
+    appendNumber(pending_, kBoxWidth);
+    pending_ += "\" height=\"";
+    appendNumber(pending_, kBoxHeight);
+    pending_ += "\"/><text text-anchor=\"middle\" dominant-baseline=\"middle\" x=\"";
+    appendNumber(pending_, left + kBoxWidth / 2);
+    pending_ += "\" y=\"";
+    appendNumber(pending_, top + kBoxHeight / 2);
+    pending_ += "\">";
+    appendXmlEscaped(pending_, node.firstName + " " + node.lastName);
+    pending_ += "</text></g>\n";
+}
+
+void OrgChartWriter::writeFooter() {
+    pending_ += format_ == Format::Dot ? "}\n" : "</svg>\n";
+}
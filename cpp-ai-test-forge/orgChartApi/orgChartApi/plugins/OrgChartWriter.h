@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "OrgLayout.h"
+
+// Renders an OrgLayout as SVG or Graphviz DOT a piece at a time, for use as
+// a stream response body. Only the text for the current node is buffered,
+// never the whole document.
+class OrgChartWriter {
+ public:
+    enum class Format { Svg, Dot };
+
+    OrgChartWriter(std::shared_ptr<const OrgLayout> layout, Format format);
+
+    // Copies up to len bytes of the document into buf; 0 once it is done.
+    auto read(char *buf, std::size_t len) -> std::size_t;
+
+ private:
+    enum class Stage { Header, Nodes, Footer, Done };
+
+    void writeHeader();
+    void writeNode(const OrgLayout::Node &node);
+    void writeFooter();
+
+    std::shared_ptr<const OrgLayout> layout_;
+    Format format_;
+    Stage stage_{Stage::Header};
+    std::size_t next_{0};
+    std::string pending_;
+    std::size_t pendingPos_{0};
+};
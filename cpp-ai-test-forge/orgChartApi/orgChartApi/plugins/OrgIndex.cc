@@ -0,0 +1,398 @@
+#include "OrgIndex.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+int bitLength(int value) {
+    int bits = 0;
+    for (; value > 0; value >>= 1) ++bits;
+    return bits;
+}
+}  // namespace
+
+void OrgIndex::addCount(Counts &counts, int32_t key, int32_t delta) {
+    auto pos = std::lower_bound(counts.begin(), counts.end(), std::make_pair(key, INT32_MIN));
+    if (pos != counts.end() && pos->first == key) {
+        pos->second += delta;
+        if (pos->second == 0) counts.erase(pos);
+    } else if (delta != 0) {
+        counts.insert(pos, {key, delta});
+    }
+}
+
+void OrgIndex::addCounts(Counts &counts, const Counts &delta, int sign) {
+    for (const auto &item : delta) addCount(counts, item.first, sign * item.second);
+}
+
+OrgIndex::OrgIndex(std::vector<Entry> entries, uint64_t version) : version_{version}, entries_{std::move(entries)} {
+    std::sort(entries_.begin(), entries_.end(), [](const Entry &a, const Entry &b) { return a.id < b.id; });
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [](const Entry &e) { return e.id < 0; }), entries_.end());
+
+    auto slotCount = static_cast<int32_t>(entries_.size());
+    liveCount_ = entries_.size();
+    auto maxId = entries_.empty() ? 0 : entries_.back().id;
+    slotOfId_.assign(static_cast<std::size_t>(maxId) + 1, kNone);
+    for (int32_t slot = 0; slot < slotCount; ++slot) slotOfId_[entries_[slot].id] = slot;
+
+    // the top of the org is stored as its own manager
+    parent_.assign(slotCount, kNone);
+    for (int32_t slot = 0; slot < slotCount; ++slot) {
+        const auto &entry = entries_[slot];
+        if (entry.managerId != entry.id) parent_[slot] = slotOf(entry.managerId);
+    }
+    breakCycles();
+
+    childOffsets_.assign(slotCount + 1, 0);
+    for (int32_t slot = 0; slot < slotCount; ++slot) {
+        if (parent_[slot] != kNone) ++childOffsets_[parent_[slot] + 1];
+    }
+    for (int32_t slot = 0; slot < slotCount; ++slot) {
+        childOffsets_[slot + 1] += childOffsets_[slot];
+    }
+    children_.resize(childOffsets_[slotCount]);
+    std::vector<int32_t> cursor(childOffsets_.begin(), childOffsets_.end() - 1);
+    for (int32_t slot = 0; slot < slotCount; ++slot) {
+        if (parent_[slot] != kNone) children_[cursor[parent_[slot]]++] = slot;
+    }
+    buildStats(buildLifting());
+}
+
+auto OrgIndex::slotOf(int32_t id) const -> int32_t {
+    if (id < 0 || static_cast<std::size_t>(id) >= slotOfId_.size()) return kNone;
+    return slotOfId_[id];
+}
+
+auto OrgIndex::childrenOf(int32_t slot) const -> Reports {
+    auto patched = patchedChildren_.find(slot);
+    if (patched != patchedChildren_.end()) {
+        const auto &list = patched->second;
+        return {list.data(), list.data() + list.size()};
+    }
+    if (static_cast<std::size_t>(slot) + 1 >= childOffsets_.size()) return {nullptr, nullptr};
+    return {children_.data() + childOffsets_[slot], children_.data() + childOffsets_[slot + 1]};
+}
+
+auto OrgIndex::mutableChildrenOf(int32_t slot) -> std::vector<int32_t> & {
+    auto patched = patchedChildren_.find(slot);
+    if (patched != patchedChildren_.end()) return patched->second;
+    auto reports = childrenOf(slot);
+    return patchedChildren_[slot] = std::vector<int32_t>(reports.begin(), reports.end());
+}
+
+// manager_id is not constrained against loops, so detach one member of every
+// loop and treat it as a root; everything else relies on parent_ being a forest.
+void OrgIndex::breakCycles() {
+    enum : char { kUnseen, kOnPath, kDone };
+    std::vector<char> state(entries_.size(), kUnseen);
+    std::vector<int32_t> path;
+    for (int32_t start = 0; start < static_cast<int32_t>(entries_.size()); ++start) {
+        auto slot = start;
+        while (slot != kNone && state[slot] == kUnseen) {
+            state[slot] = kOnPath;
+            path.push_back(slot);
+            slot = parent_[slot];
+        }
+        if (slot != kNone && state[slot] == kOnPath) parent_[slot] = kNone;
+        for (auto s : path) state[s] = kDone;
+        path.clear();
+    }
+}
+
+auto OrgIndex::buildLifting() -> std::vector<int32_t> {
+    auto slotCount = static_cast<int32_t>(entries_.size());
+    depth_.assign(slotCount, 0);
+    up_.assign(1, std::vector<int32_t>(slotCount));
+
+    // visit managers before their reports so depth_ of the parent is final
+    std::vector<int32_t> order;
+    order.reserve(slotCount);
+    for (int32_t slot = 0; slot < slotCount; ++slot) {
+        if (parent_[slot] == kNone) order.push_back(slot);
+    }
+    int maxDepth = 0;
+    for (std::size_t head = 0; head < order.size(); ++head) {
+        auto slot = order[head];
+        auto parent = parent_[slot];
+        up_[0][slot] = parent == kNone ? slot : parent;
+        depth_[slot] = parent == kNone ? 0 : depth_[parent] + 1;
+        maxDepth = std::max(maxDepth, depth_[slot]);
+        for (auto child : childrenOf(slot)) order.push_back(child);
+    }
+
+    for (int span = 1; span <= maxDepth; span *= 2) {
+        const auto &prev = up_.back();
+        std::vector<int32_t> next(slotCount);
+        for (int32_t slot = 0; slot < slotCount; ++slot) next[slot] = prev[prev[slot]];
+        up_.push_back(std::move(next));
+    }
+    return order;
+}
+
+// single bottom-up pass: every report is folded into its manager after its
+// own subtree is complete
+void OrgIndex::buildStats(const std::vector<int32_t> &topDown) {
+    stats_.assign(entries_.size(), Stats{});
+    for (auto it = topDown.rbegin(); it != topDown.rend(); ++it) {
+        auto slot = *it;
+        auto &stats = stats_[slot];
+        stats.headcount += 1;
+        addCount(stats.departments, entries_[slot].departmentId, 1);
+        addCount(stats.jobs, entries_[slot].jobId, 1);
+
+        auto parent = parent_[slot];
+        if (parent == kNone) continue;
+        auto &parentStats = stats_[parent];
+        parentStats.headcount += stats.headcount;
+        parentStats.height = std::max(parentStats.height, stats.height + 1);
+        addCounts(parentStats.departments, stats.departments, 1);
+        addCounts(parentStats.jobs, stats.jobs, 1);
+    }
+}
+
+void OrgIndex::addToChain(int32_t from, const Stats &delta, int sign) {
+    for (auto s = from; s != kNone; s = parent_[s]) {
+        stats_[s].headcount += sign * delta.headcount;
+        addCounts(stats_[s].departments, delta.departments, sign);
+        addCounts(stats_[s].jobs, delta.jobs, sign);
+    }
+}
+
+void OrgIndex::refreshHeights(int32_t from) {
+    for (auto s = from; s != kNone; s = parent_[s]) {
+        int32_t height = 0;
+        for (auto child : childrenOf(s)) height = std::max(height, stats_[child].height + 1);
+        if (height == stats_[s].height && s != from) break;
+        stats_[s].height = height;
+    }
+}
+
+// Recomputes depth_ and up_ below slot after its parent changed. Ancestors
+// outside the subtree are untouched, so a top-down pass is enough.
+void OrgIndex::relift(int32_t slot) {
+    std::vector<int32_t> order{slot};
+    for (std::size_t head = 0; head < order.size(); ++head) {
+        auto s = order[head];
+        depth_[s] = parent_[s] == kNone ? 0 : depth_[parent_[s]] + 1;
+        if (bitLength(depth_[s]) > static_cast<int>(up_.size())) {
+            // the org got deeper than the table covers; rare enough to rebuild
+            buildLifting();
+            return;
+        }
+        for (auto child : childrenOf(s)) order.push_back(child);
+    }
+    for (auto s : order) {
+        up_[0][s] = parent_[s] == kNone ? s : parent_[s];
+        for (std::size_t k = 1; k < up_.size(); ++k) up_[k][s] = up_[k - 1][up_[k - 1][s]];
+    }
+}
+
+void OrgIndex::attach(int32_t slot, int32_t parent) {
+    parent_[slot] = parent;
+    if (parent == kNone) return;
+    auto &siblings = mutableChildrenOf(parent);
+    auto id = entries_[slot].id;
+    auto pos = std::lower_bound(siblings.begin(), siblings.end(), id,
+                                [this](int32_t s, int32_t value) { return entries_[s].id < value; });
+    siblings.insert(pos, slot);
+    addToChain(parent, stats_[slot], 1);
+    refreshHeights(parent);
+}
+
+void OrgIndex::detach(int32_t slot) {
+    auto parent = parent_[slot];
+    if (parent == kNone) return;
+    addToChain(parent, stats_[slot], -1);
+    parent_[slot] = kNone;
+    auto &siblings = mutableChildrenOf(parent);
+    siblings.erase(std::find(siblings.begin(), siblings.end(), slot));
+    refreshHeights(parent);
+}
+
+auto OrgIndex::isAncestor(int32_t ancestor, int32_t slot) const -> bool {
+    auto lift = depth_[slot] - depth_[ancestor];
+    if (lift < 0) return false;
+    for (std::size_t k = 0; lift > 0; ++k, lift >>= 1) {
+        if (lift & 1) slot = up_[k][slot];
+    }
+    return slot == ancestor;
+}
+
+auto OrgIndex::find(int32_t id) const -> const Entry * {
+    auto slot = slotOf(id);
+    return slot == kNone ? nullptr : &entries_[slot];
+}
+
+auto OrgIndex::reportsOf(int32_t id) const -> std::vector<int32_t> {
+    std::vector<int32_t> ret;
+    auto slot = slotOf(id);
+    if (slot == kNone) return ret;
+    auto reports = childrenOf(slot);
+    ret.reserve(reports.size());
+    for (auto child : reports) ret.push_back(entries_[child].id);
+    return ret;
+}
+
+auto OrgIndex::roots() const -> std::vector<int32_t> {
+    std::vector<int32_t> ret;
+    for (int32_t slot = 0; slot < static_cast<int32_t>(entries_.size()); ++slot) {
+        if (parent_[slot] == kNone && slotOf(entries_[slot].id) == slot) ret.push_back(entries_[slot].id);
+    }
+    return ret;
+}
+
+auto OrgIndex::managerOf(int32_t id) const -> std::optional<int32_t> {
+    auto slot = slotOf(id);
+    if (slot == kNone || parent_[slot] == kNone) return std::nullopt;
+    return entries_[parent_[slot]].id;
+}
+
+auto OrgIndex::depthOf(int32_t id) const -> int {
+    auto slot = slotOf(id);
+    return slot == kNone ? -1 : depth_[slot];
+}
+
+auto OrgIndex::statsOf(int32_t id) const -> const Stats * {
+    auto slot = slotOf(id);
+    return slot == kNone ? nullptr : &stats_[slot];
+}
+
+auto OrgIndex::chainOf(int32_t id) const -> std::vector<int32_t> {
+    std::vector<int32_t> ret;
+    auto slot = slotOf(id);
+    if (slot == kNone) return ret;
+    ret.reserve(depth_[slot]);
+    for (auto s = parent_[slot]; s != kNone; s = parent_[s]) ret.push_back(entries_[s].id);
+    return ret;
+}
+
+auto OrgIndex::commonManager(int32_t a, int32_t b) const -> std::optional<int32_t> {
+    auto x = slotOf(a);
+    auto y = slotOf(b);
+    if (x == kNone || y == kNone) return std::nullopt;
+
+    if (depth_[x] < depth_[y]) std::swap(x, y);
+    auto lift = depth_[x] - depth_[y];
+    for (std::size_t k = 0; lift > 0; ++k, lift >>= 1) {
+        if (lift & 1) x = up_[k][x];
+    }
+    if (x == y) return entries_[x].id;
+
+    for (auto k = up_.size(); k-- > 0;) {
+        if (up_[k][x] != up_[k][y]) {
+            x = up_[k][x];
+            y = up_[k][y];
+        }
+    }
+    // x and y are now direct reports of the answer, or two distinct roots
+    if (up_[0][x] != up_[0][y]) return std::nullopt;
+    return entries_[up_[0][x]].id;
+}
+
+auto OrgIndex::manages(int32_t managerId, int32_t id) const -> bool {
+    auto manager = slotOf(managerId);
+    auto slot = slotOf(id);
+    if (manager == kNone || slot == kNone || manager == slot) return false;
+    return isAncestor(manager, slot);
+}
+
+auto OrgIndex::findCycle(const std::unordered_map<int32_t, int32_t> &managers) const -> std::optional<int32_t> {
+    enum : char { kOnPath = 1, kDone };
+    std::unordered_map<int32_t, char> state;
+    auto managerAfter = [this, &managers](int32_t id) -> std::optional<int32_t> {
+        auto change = managers.find(id);
+        if (change == managers.end()) return managerOf(id);
+        if (change->second == id) return std::nullopt;
+        return change->second;
+    };
+
+    std::vector<int32_t> path;
+    for (const auto &change : managers) {
+        std::optional<int32_t> id = change.first;
+        while (id && state[*id] == 0) {
+            state[*id] = kOnPath;
+            path.push_back(*id);
+            id = managerAfter(*id);
+        }
+        if (id && state[*id] == kOnPath) return id;
+        for (auto visited : path) state[visited] = kDone;
+        path.clear();
+    }
+    return std::nullopt;
+}
+
+auto OrgIndex::subtree(int32_t id, int maxDepth) const -> std::vector<SubtreeNode> {
+    std::vector<SubtreeNode> ret;
+    auto root = slotOf(id);
+    if (root == kNone) return ret;
+
+    // the result vector doubles as the BFS queue
+    ret.push_back({&entries_[root], 0});
+    for (std::size_t head = 0; head < ret.size(); ++head) {
+        auto slot = static_cast<int32_t>(ret[head].entry - entries_.data());
+        auto depth = ret[head].depth;
+        if (maxDepth >= 0 && depth >= maxDepth) continue;
+        for (auto child : childrenOf(slot)) ret.push_back({&entries_[child], depth + 1});
+    }
+    return ret;
+}
+
+auto OrgIndex::upsert(const Entry &entry) -> bool {
+    if (entry.id < 0) return false;
+    auto slot = slotOf(entry.id);
+    auto parent = entry.managerId == entry.id ? kNone : slotOf(entry.managerId);
+
+    if (slot == kNone) {
+        slot = static_cast<int32_t>(entries_.size());
+        if (static_cast<std::size_t>(entry.id) >= slotOfId_.size()) slotOfId_.resize(entry.id + 1, kNone);
+        slotOfId_[entry.id] = slot;
+        entries_.push_back(entry);
+        parent_.push_back(kNone);
+        depth_.push_back(0);
+        stats_.push_back({1, 0, {{entry.departmentId, 1}}, {{entry.jobId, 1}}});
+        for (auto &level : up_) level.push_back(slot);
+        ++liveCount_;
+        attach(slot, parent);
+        relift(slot);
+        ++version_;
+        return true;
+    }
+
+    if (parent != parent_[slot]) {
+        if (parent != kNone && (parent == slot || isAncestor(slot, parent))) return false;
+        detach(slot);
+        attach(slot, parent);
+        relift(slot);
+    }
+
+    // department and job changes only touch the breakdowns up the chain
+    auto &current = entries_[slot];
+    if (current.departmentId != entry.departmentId || current.jobId != entry.jobId) {
+        Stats before{0, 0, {{current.departmentId, 1}}, {{current.jobId, 1}}};
+        Stats after{0, 0, {{entry.departmentId, 1}}, {{entry.jobId, 1}}};
+        addToChain(slot, before, -1);
+        addToChain(slot, after, 1);
+    }
+    entries_[slot] = entry;
+    ++version_;
+    return true;
+}
+
+auto OrgIndex::remove(int32_t id) -> bool {
+    auto slot = slotOf(id);
+    if (slot == kNone) return false;
+
+    detach(slot);
+    auto reports = childrenOf(slot);
+    std::vector<int32_t> orphans(reports.begin(), reports.end());
+    patchedChildren_[slot].clear();
+    for (auto child : orphans) {
+        parent_[child] = kNone;
+        relift(child);
+    }
+    stats_[slot] = Stats{};
+    // the slot stays allocated as a tombstone until the next full load
+    slotOfId_[id] = kNone;
+    --liveCount_;
+    ++version_;
+    return true;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// In-memory copy of the person.manager_id hierarchy.
+//
+// Persons are stored in dense slots; ids map to slots through slotOfId_ (ids
+// come from a SERIAL column, so the table stays compact). The reports of slot
+// s live in children_[childOffsets_[s] .. childOffsets_[s + 1]); once a slot's
+// reports change after the build, its list moves to patchedChildren_.
+// Ancestor queries use binary lifting: up_[k][s] is the 2^k-th manager of s,
+// with roots pointing at themselves.
+//
+// Per-slot Stats are aggregated bottom-up at build time and then adjusted
+// along the management chain on every write.
+//
+// Every successful write bumps version(), so readers can key caches on it.
+class OrgIndex {
+ public:
+    struct Entry {
+        int32_t id;
+        int32_t managerId;
+        int32_t departmentId;
+        int32_t jobId;
+        std::string firstName;
+        std::string lastName;
+    };
+
+    struct SubtreeNode {
+        const Entry *entry;
+        int depth;
+    };
+
+    // (department or job id, headcount), sorted by id
+    using Counts = std::vector<std::pair<int32_t, int32_t>>;
+
+    // Aggregates over a person and everyone below them.
+    struct Stats {
+        int32_t headcount{0};
+        int32_t height{0};
+        Counts departments;
+        Counts jobs;
+    };
+
+    // Adds sign * delta into counts, dropping ids whose count reaches zero.
+    static void addCount(Counts &counts, int32_t key, int32_t delta);
+    static void addCounts(Counts &counts, const Counts &delta, int sign);
+
+    OrgIndex() = default;
+    explicit OrgIndex(std::vector<Entry> entries, uint64_t version = 0);
+
+    auto size() const -> std::size_t { return liveCount_; }
+    auto version() const -> uint64_t { return version_; }
+    auto contains(int32_t id) const -> bool { return slotOf(id) != kNone; }
+    auto find(int32_t id) const -> const Entry *;
+    auto reportsOf(int32_t id) const -> std::vector<int32_t>;
+    auto roots() const -> std::vector<int32_t>;
+    // Direct manager as seen by the index; empty for roots and unknown ids.
+    auto managerOf(int32_t id) const -> std::optional<int32_t>;
+    auto depthOf(int32_t id) const -> int;
+    auto statsOf(int32_t id) const -> const Stats *;
+
+    // Managers of id from the direct manager up to the root.
+    auto chainOf(int32_t id) const -> std::vector<int32_t>;
+    // Lowest person that manages both a and b, in O(log n). When one of them
+    // manages the other, that one is returned. Empty if either id is unknown
+    // or they sit in different trees.
+    auto commonManager(int32_t a, int32_t b) const -> std::optional<int32_t>;
+    // True if managerId is somewhere on id's management chain.
+    auto manages(int32_t managerId, int32_t id) const -> bool;
+
+    // Checks a batch of manager changes (person id -> new manager id, the id
+    // itself for a root) against the current tree. Every person is visited
+    // at most once, so this is linear in the batch plus the chains it walks.
+    // Returns a person that would end up on a management cycle.
+    auto findCycle(const std::unordered_map<int32_t, int32_t> &managers) const -> std::optional<int32_t>;
+
+    // Breadth-first walk below id, id itself included at depth 0. A negative
+    // maxDepth means no limit.
+    auto subtree(int32_t id, int maxDepth = -1) const -> std::vector<SubtreeNode>;
+
+    // Adds a new person or applies an update to an existing one. A manager
+    // change re-parents the whole subtree in O(subtree size * log n). Returns
+    // false, leaving the index untouched, if the move would create a cycle.
+    auto upsert(const Entry &entry) -> bool;
+    // Removes a person; any remaining reports become roots.
+    auto remove(int32_t id) -> bool;
+
+ private:
+    static constexpr int32_t kNone = -1;
+
+    struct Reports {
+        const int32_t *first;
+        const int32_t *last;
+        auto begin() const -> const int32_t * { return first; }
+        auto end() const -> const int32_t * { return last; }
+        auto size() const -> std::size_t { return static_cast<std::size_t>(last - first); }
+    };
+
+    auto slotOf(int32_t id) const -> int32_t;
+    auto childrenOf(int32_t slot) const -> Reports;
+    auto mutableChildrenOf(int32_t slot) -> std::vector<int32_t> &;
+    auto isAncestor(int32_t ancestor, int32_t slot) const -> bool;
+    void breakCycles();
+    auto buildLifting() -> std::vector<int32_t>;
+    void relift(int32_t slot);
+    void attach(int32_t slot, int32_t parent);
+    void detach(int32_t slot);
+    void buildStats(const std::vector<int32_t> &topDown);
+    void addToChain(int32_t from, const Stats &delta, int sign);
+    void refreshHeights(int32_t from);
+
+    uint64_t version_{0};
+    std::size_t liveCount_{0};
+    std::vector<Entry> entries_;
+    std::vector<int32_t> slotOfId_;
+    std::vector<int32_t> parent_;
+    std::vector<int32_t> childOffsets_{0};
+    std::vector<int32_t> children_;
+    std::unordered_map<int32_t, std::vector<int32_t>> patchedChildren_;
+    std::vector<int32_t> depth_;
+    std::vector<Stats> stats_;
+    std::vector<std::vector<int32_t>> up_ = std::vector<std::vector<int32_t>>(1);
+};
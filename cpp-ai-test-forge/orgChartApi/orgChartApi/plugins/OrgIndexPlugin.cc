@@ -0,0 +1,160 @@
+#include "OrgIndexPlugin.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace drogon;
+using namespace drogon::orm;
+using namespace drogon_model::org_chart;
+
+void OrgIndexPlugin::initAndStart(const Json::Value &config) {
+    LOG_DEBUG << "OrgIndex initialized and Start";
+    maxLayouts_ = config.get("max_cached_layouts", 256).asUInt();
+    maxLoadRetryDelay_ = config.get("max_load_retry_delay", 60.0).asDouble();
+    // db clients are only usable once the main loop runs
+    app().getLoop()->queueInLoop([this]() { load(); });
+}
+
+void OrgIndexPlugin::shutdown() {
+    LOG_DEBUG << "OrgIndex shut down";
+    if (loadRetryTimer_ != 0) app().getLoop()->invalidateTimer(loadRetryTimer_);
+}
+
+auto OrgIndexPlugin::isReady() const -> bool {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return ready_;
+}
+
+auto OrgIndexPlugin::version() const -> uint64_t {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return index_->version();
+}
+
+auto OrgIndexPlugin::layoutOf(int32_t rootId) const -> std::shared_ptr<const OrgLayout> {
+    // the shared lock pins the version until the layout is cached
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto version = index_->version();
+    {
+        std::lock_guard<std::mutex> cacheLock(layoutMutex_);
+        if (layoutVersion_ != version) {
+            layouts_.clear();
+            layoutVersion_ = version;
+        }
+        auto it = layouts_.find(rootId);
+        if (it != layouts_.end()) return it->second;
+    }
+
+    auto layout = OrgLayout::compute(*index_, rootId);
+    if (!layout) return nullptr;
+    auto layoutPtr = std::make_shared<const OrgLayout>(std::move(*layout));
+    std::lock_guard<std::mutex> cacheLock(layoutMutex_);
+    if (layouts_.size() >= maxLayouts_) layouts_.clear();
+    layouts_.emplace(rootId, layoutPtr);
+    return layoutPtr;
+}
+
+void OrgIndexPlugin::personSaved(const Person &person) {
+    personsSaved({person});
+}
+
+void OrgIndexPlugin::personsSaved(const std::vector<Person> &persons) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (loading_) {
+        // the running load may have read the table before this write
+        reloadPending_ = true;
+        return;
+    }
+    std::vector<OrgIndex::Entry> entries;
+    entries.reserve(persons.size());
+    for (const auto &person : persons) {
+        entries.push_back({
+            person.getValueOfId(),
+            person.getManagerId() ? person.getValueOfManagerId() : person.getValueOfId(),
+            person.getValueOfDepartmentId(),
+            person.getValueOfJobId(),
+            person.getValueOfFirstName(),
+            person.getValueOfLastName()});
+    }
+
+    // a batch is only acyclic as a whole, so lift every moved person out
+    // first; applying it in row order could pass through a cycle
+    if (entries.size() > 1) {
+        for (auto entry : entries) {
+            const auto *current = index_->find(entry.id);
+            if (!current || current->managerId == entry.managerId) continue;
+            entry.managerId = entry.id;
+            index_->upsert(entry);
+        }
+    }
+    for (const auto &entry : entries) {
+        if (!index_->upsert(entry)) {
+            LOG_WARN << "OrgIndex rejected move of person " << entry.id << ", reloading";
+            lock.unlock();
+            load();
+            return;
+        }
+    }
+}
+
+void OrgIndexPlugin::personDeleted(int32_t personId) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (loading_) {
+        reloadPending_ = true;
+        return;
+    }
+    index_->remove(personId);
+}
+
+void OrgIndexPlugin::load() {
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (loading_) {
+            reloadPending_ = true;
+            return;
+        }
+        loading_ = true;
+        reloadPending_ = false;
+    }
+
+    auto dbClientPtr = app().getDbClient();
+    *dbClientPtr << "select id, manager_id, department_id, job_id, first_name, last_name from person"
+                 >> [this](const Result &result)
+                   {
+                      std::vector<OrgIndex::Entry> entries;
+                      entries.reserve(result.size());
+                      for (const auto &row : result) {
+                          entries.push_back({
+                              row["id"].as<int32_t>(),
+                              row["manager_id"].isNull() ? row["id"].as<int32_t>() : row["manager_id"].as<int32_t>(),
+                              row["department_id"].isNull() ? 0 : row["department_id"].as<int32_t>(),
+                              row["job_id"].isNull() ? 0 : row["job_id"].as<int32_t>(),
+                              row["first_name"].as<std::string>(),
+                              row["last_name"].as<std::string>()});
+                      }
+
+                      std::unique_lock<std::shared_mutex> lock(mutex_);
+                      index_ = std::make_unique<OrgIndex>(std::move(entries), index_->version() + 1);
+                      LOG_INFO << "OrgIndex loaded " << index_->size() << " persons";
+                      loading_ = false;
+                      loadRetryDelay_ = 1;
+                      if (reloadPending_) {
+                          lock.unlock();
+                          load();
+                          return;
+                      }
+                      ready_ = true;
+                   }
+                 >> [this](const DrogonDbException &e)
+                   {
+                      std::unique_lock<std::shared_mutex> lock(mutex_);
+                      loading_ = false;
+                      auto delay = loadRetryDelay_;
+                      loadRetryDelay_ = std::min(loadRetryDelay_ * 2, maxLoadRetryDelay_);
+                      LOG_ERROR << "OrgIndex load failed, retrying in " << delay << "s: " << e.base().what();
+                      loadRetryTimer_ = app().getLoop()->runAfter(delay, [this]() {
+                          loadRetryTimer_ = 0;
+                          load();
+                      });
+                   };
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <drogon/plugins/Plugin.h>
+#include <trantor/net/EventLoop.h>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "OrgIndex.h"
+#include "OrgLayout.h"
+#include "../models/Person.h"
+
+// Owns the process-wide OrgIndex. The index is loaded from the person table
+// once the event loop is running; until then isReady() is false and callers
+// should fall back to the database. A failed load is retried with a backoff
+// doubling up to max_load_retry_delay seconds. Person write handlers report successful
+// writes through personSaved()/personDeleted(), which patch the index in
+// place instead of reloading it.
+class OrgIndexPlugin : public drogon::Plugin<OrgIndexPlugin> {
+ public:
+    virtual void initAndStart(const Json::Value &config) override;
+    virtual void shutdown() override;
+
+    auto isReady() const -> bool;
+    auto version() const -> uint64_t;
+
+    // Runs fn(const OrgIndex &) under a shared lock and returns its result.
+    template <typename Fn>
+    auto read(Fn &&fn) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return fn(static_cast<const OrgIndex &>(*index_));
+    }
+
+    // Tidy-tree layout of the subtree under rootId, computed once per org
+    // version and shared between requests. nullptr for unknown ids.
+    auto layoutOf(int32_t rootId) const -> std::shared_ptr<const OrgLayout>;
+
+    void personSaved(const drogon_model::org_chart::Person &person);
+    void personsSaved(const std::vector<drogon_model::org_chart::Person> &persons);
+    void personDeleted(int32_t personId);
+
+ private:
+    void load();
+
+    mutable std::shared_mutex mutex_;
+    std::unique_ptr<OrgIndex> index_{std::make_unique<OrgIndex>()};
+    bool ready_{false};
+    bool loading_{false};
+    bool reloadPending_{false};
+    double loadRetryDelay_{1};
+    double maxLoadRetryDelay_{60};
+    trantor::TimerId loadRetryTimer_{0};
+
+    std::size_t maxLayouts_{256};
+    mutable std::mutex layoutMutex_;
+    mutable uint64_t layoutVersion_{0};
+    mutable std::unordered_map<int32_t, std::shared_ptr<const OrgLayout>> layouts_;
+};
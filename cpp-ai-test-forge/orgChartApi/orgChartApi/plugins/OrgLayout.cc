@@ -0,0 +1,189 @@
+#include "OrgLayout.h"
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+constexpr int32_t kNone = -1;
+constexpr double kDistance = 1.0;
+
+// Working state, indexed by position in the breadth-first node list.
+struct Tree {
+    std::vector<int32_t> parent;
+    std::vector<int32_t> firstChild;
+    std::vector<int32_t> childCount;
+    std::vector<int32_t> number;  // 1-based position among siblings
+    std::vector<double> prelim;
+    std::vector<double> mod;
+    std::vector<double> shift;
+    std::vector<double> change;
+    std::vector<int32_t> thread;
+    std::vector<int32_t> ancestor;
+
+    explicit Tree(std::size_t size)
+        : parent(size, kNone), firstChild(size, kNone), childCount(size, 0), number(size, 1),
+          prelim(size, 0), mod(size, 0), shift(size, 0), change(size, 0), thread(size, kNone), ancestor(size) {
+        for (std::size_t v = 0; v < size; ++v) ancestor[v] = static_cast<int32_t>(v);
+    }
+
+    // breadth-first order keeps siblings contiguous
+    auto child(int32_t v, int32_t i) const -> int32_t { return firstChild[v] + i; }
+    auto lastChild(int32_t v) const -> int32_t { return firstChild[v] + childCount[v] - 1; }
+    auto isLeaf(int32_t v) const -> bool { return childCount[v] == 0; }
+    auto leftSibling(int32_t v) const -> int32_t { return number[v] > 1 ? v - 1 : kNone; }
+    auto leftmostSibling(int32_t v) const -> int32_t { return parent[v] == kNone ? v : firstChild[parent[v]]; }
+    auto nextLeft(int32_t v) const -> int32_t { return isLeaf(v) ? thread[v] : firstChild[v]; }
+    auto nextRight(int32_t v) const -> int32_t { return isLeaf(v) ? thread[v] : lastChild(v); }
+
+    void moveSubtree(int32_t wm, int32_t wp, double amount) {
+        auto subtrees = static_cast<double>(number[wp] - number[wm]);
+        change[wp] -= amount / subtrees;
+        shift[wp] += amount;
+        change[wm] += amount / subtrees;
+        prelim[wp] += amount;
+        mod[wp] += amount;
+    }
+
+    void executeShifts(int32_t v) {
+        double totalShift = 0;
+        double totalChange = 0;
+        for (auto w = lastChild(v); w >= firstChild[v]; --w) {
+            prelim[w] += totalShift;
+            mod[w] += totalShift;
+            totalChange += change[w];
+            totalShift += shift[w] + totalChange;
+        }
+    }
+
+    auto apportion(int32_t v, int32_t defaultAncestor) -> int32_t {
+        auto w = leftSibling(v);
+        if (w == kNone) return defaultAncestor;
+
+        auto vip = v;
+        auto vop = v;
+        auto vim = w;
+        auto vom = leftmostSibling(vip);
+        auto sip = mod[vip];
+        auto sop = mod[vop];
+        auto sim = mod[vim];
+        auto som = mod[vom];
+        while (nextRight(vim) != kNone && nextLeft(vip) != kNone) {
+            vim = nextRight(vim);
+            vip = nextLeft(vip);
+            vom = nextLeft(vom);
+            vop = nextRight(vop);
+            ancestor[vop] = v;
+            auto amount = (prelim[vim] + sim) - (prelim[vip] + sip) + kDistance;
+            if (amount > 0) {
+                auto wm = parent[ancestor[vim]] == parent[v] ? ancestor[vim] : defaultAncestor;
+                moveSubtree(wm, v, amount);
+                sip += amount;
+                sop += amount;
+            }
+            sim += mod[vim];
+            sip += mod[vip];
+            som += mod[vom];
+            sop += mod[vop];
+        }
+        if (nextRight(vim) != kNone && nextRight(vop) == kNone) {
+            thread[vop] = nextRight(vim);
+            mod[vop] += sim - sop;
+        }
+        if (nextLeft(vip) != kNone && nextLeft(vom) == kNone) {
+            thread[vom] = nextLeft(vip);
+            mod[vom] += sip - som;
+            defaultAncestor = v;
+        }
+        return defaultAncestor;
+    }
+
+    // the tail of the recursive first walk, once v's subtree is laid out
+    void place(int32_t v) {
+        auto w = leftSibling(v);
+        if (isLeaf(v)) {
+            prelim[v] = w == kNone ? 0 : prelim[w] + kDistance;
+            return;
+        }
+        executeShifts(v);
+        auto midpoint = (prelim[firstChild[v]] + prelim[lastChild(v)]) / 2;
+        if (w == kNone) {
+            prelim[v] = midpoint;
+        } else {
+            prelim[v] = prelim[w] + kDistance;
+            mod[v] = prelim[v] - midpoint;
+        }
+    }
+};
+}  // namespace
+
+auto OrgLayout::compute(const OrgIndex &index, int32_t rootId) -> std::optional<OrgLayout> {
+    auto nodes = index.subtree(rootId);
+    if (nodes.empty()) return std::nullopt;
+
+    auto size = static_cast<int32_t>(nodes.size());
+    Tree tree(nodes.size());
+    std::vector<int32_t> managerIds(nodes.size());
+    {
+        // subtree() lists each manager's reports contiguously and in order
+        std::unordered_map<int32_t, int32_t> position;
+        position.reserve(nodes.size());
+        for (int32_t v = 0; v < size; ++v) position.emplace(nodes[v].entry->id, v);
+        managerIds[0] = rootId;
+        for (int32_t v = 1; v < size; ++v) {
+            managerIds[v] = *index.managerOf(nodes[v].entry->id);
+            auto p = position.at(managerIds[v]);
+            tree.parent[v] = p;
+            if (tree.firstChild[p] == kNone) tree.firstChild[p] = v;
+            tree.number[v] = ++tree.childCount[p];
+        }
+    }
+
+    // first walk, post-order without recursion: a node is placed when its
+    // last report is done, then apportioned against its left siblings
+    std::vector<int32_t> defaultAncestor(nodes.size(), kNone);
+    std::vector<std::pair<int32_t, int32_t>> stack{{0, 0}};
+    while (!stack.empty()) {
+        auto &frame = stack.back();
+        auto v = frame.first;
+        if (frame.second < tree.childCount[v]) {
+            if (frame.second == 0) defaultAncestor[v] = tree.firstChild[v];
+            stack.push_back({tree.child(v, frame.second++), 0});
+            continue;
+        }
+        stack.pop_back();
+        tree.place(v);
+        auto p = tree.parent[v];
+        if (p != kNone) defaultAncestor[p] = tree.apportion(v, defaultAncestor[p]);
+    }
+
+    // second walk: parents come before reports in breadth-first order
+    std::vector<double> modSum(nodes.size(), 0);
+    std::vector<double> x(nodes.size(), 0);
+    auto minX = 0.0;
+    auto maxX = 0.0;
+    for (int32_t v = 0; v < size; ++v) {
+        auto p = tree.parent[v];
+        if (p != kNone) modSum[v] = modSum[p] + tree.mod[p];
+        x[v] = tree.prelim[v] + modSum[v];
+        minX = v == 0 ? x[v] : std::min(minX, x[v]);
+        maxX = v == 0 ? x[v] : std::max(maxX, x[v]);
+    }
+
+    OrgLayout layout;
+    layout.version = index.version();
+    layout.width = maxX - minX;
+    layout.nodes.reserve(nodes.size());
+    for (int32_t v = 0; v < size; ++v) {
+        const auto *entry = nodes[v].entry;
+        layout.nodes.push_back({
+            entry->id,
+            managerIds[v],
+            tree.parent[v],
+            x[v] - minX,
+            nodes[v].depth,
+            entry->firstName,
+            entry->lastName});
+        layout.height = std::max(layout.height, nodes[v].depth);
+    }
+    return layout;
+}
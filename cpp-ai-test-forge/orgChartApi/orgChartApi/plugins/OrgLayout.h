@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "OrgIndex.h"
+
+// Tidy-tree layout of one subtree of the org (Reingold-Tilford, with
+// Buchheim, Juenger and Leipert's linear-time apportioning).
+//
+// Coordinates are in node units: siblings are at least one unit apart, and
+// y is the depth below the root. The leftmost node sits at x = 0.
+struct OrgLayout {
+    struct Node {
+        int32_t id;
+        int32_t managerId;
+        int32_t parent;  // position of the manager in nodes, -1 for the root
+        double x;
+        int y;
+        std::string firstName;
+        std::string lastName;
+    };
+
+    uint64_t version{0};
+    double width{0};
+    int height{0};
+    // breadth-first from the root, the order OrgIndex::subtree() returns
+    std::vector<Node> nodes;
+
+    static auto compute(const OrgIndex &index, int32_t rootId) -> std::optional<OrgLayout>;
+};
@@ -0,0 +1,41 @@
+#include "PasswordHasherPlugin.h"
+#include <third_party/libbcrypt/include/bcrypt/BCrypt.hpp>
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <thread>
+
+using namespace drogon;
+
+void PasswordHasherPlugin::initAndStart(const Json::Value &config) {
+    LOG_DEBUG << "PasswordHasher initialized and Start";
+    // half the cores by default, leaving the rest to the IO loops
+    auto threads = config.get("threads", std::max(1u, std::thread::hardware_concurrency() / 2)).asUInt();
+    pool_ = std::make_unique<WorkerPool>(threads, config.get("queue_depth", 64).asUInt());
+    retryAfter_ = config.get("retry_after", 1).asInt();
+}
+
+void PasswordHasherPlugin::shutdown() {
+    LOG_DEBUG << "PasswordHasher shut down";
+    pool_->stop();
+}
+
+auto PasswordHasherPlugin::hash(std::string password) -> Awaiter<std::string> {
+    return Awaiter<std::string>(*pool_, [password = std::move(password)]() {
+        return BCrypt::generateHash(password);
+    });
+}
+
+auto PasswordHasherPlugin::verify(std::string password, std::string hash) -> Awaiter<bool> {
+    return Awaiter<bool>(*pool_, [password = std::move(password), hash = std::move(hash)]() {
+        return BCrypt::validatePassword(password, hash);
+    });
+}
+
+auto PasswordHasherPlugin::busyResponse() const -> HttpResponsePtr {
+    Json::Value ret{};
+    ret["error"] = "too many password checks in progress, try again later";
+    auto resp = HttpResponse::newHttpJsonResponse(ret);
+    resp->setStatusCode(k503ServiceUnavailable);
+    resp->addHeader("Retry-After", std::to_string(retryAfter_));
+    return resp;
+}
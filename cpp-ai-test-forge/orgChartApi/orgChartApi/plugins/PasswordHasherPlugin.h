@@ -0,0 +1,79 @@
+#pragma once
+
+#include <drogon/HttpResponse.h>
+#include <drogon/plugins/Plugin.h>
+#include <drogon/utils/coroutine.h>
+#include <trantor/net/EventLoop.h>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include "WorkerPool.h"
+
+// bcrypt hashing and checking on a WorkerPool of their own, so a burst of
+// logins waits here rather than on the IO loops. An awaited hash() or
+// verify() gives std::nullopt when the pool's queue is full; answer with
+// busyResponse() then.
+class PasswordHasherPlugin : public drogon::Plugin<PasswordHasherPlugin> {
+ public:
+    // Runs work on the pool, then resumes the coroutine on the loop it was
+    // suspended on. Off any loop, the worker and await_suspend race on a
+    // flag and whichever comes second resumes, so the frame is never
+    // resumed while await_suspend is still running.
+    template <typename T>
+    class Awaiter : public drogon::CallbackAwaiter<std::optional<T>> {
+     public:
+        Awaiter(WorkerPool &pool, std::function<T()> work) : pool_(pool), work_(std::move(work)) {}
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            auto *loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+            auto posted = pool_.post([this, handle, loop, work = std::move(work_)]() {
+                std::optional<T> value;
+                std::exception_ptr error;
+                try {
+                    value = work();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                if (loop) {
+                    // the loop is inside await_suspend until it returns, so
+                    // this cannot run before then
+                    loop->queueInLoop([this, handle, value = std::move(value), error]() {
+                        if (error) this->setException(error); else this->setValue(value);
+                        handle.resume();
+                    });
+                    return;
+                }
+                if (error) this->setException(error); else this->setValue(std::move(value));
+                if (finished_.exchange(true, std::memory_order_acq_rel)) handle.resume();
+            });
+            // not suspended after all
+            if (!posted) {
+                this->setValue(std::nullopt);
+                return false;
+            }
+            // already done off-loop: carry on without suspending
+            return loop || !finished_.exchange(true, std::memory_order_acq_rel);
+        }
+
+     private:
+        WorkerPool &pool_;
+        std::function<T()> work_;
+        std::atomic<bool> finished_{false};
+    };
+
+    virtual void initAndStart(const Json::Value &config) override;
+    virtual void shutdown() override;
+
+    auto hash(std::string password) -> Awaiter<std::string>;
+    auto verify(std::string password, std::string hash) -> Awaiter<bool>;
+    // 503 with Retry-After, for when an await came back empty
+    auto busyResponse() const -> drogon::HttpResponsePtr;
+
+ private:
+    std::unique_ptr<WorkerPool> pool_;
+    int retryAfter_{1};
+};
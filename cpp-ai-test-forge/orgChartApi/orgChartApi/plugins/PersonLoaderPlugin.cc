@@ -0,0 +1,72 @@
+#include "PersonLoaderPlugin.h"
+#include <drogon/drogon.h>
+#include <memory>
+#include <utility>
+#include "../utils/utils.h"
+
+using namespace drogon;
+using namespace drogon::orm;
+
+void PersonLoaderPlugin::initAndStart(const Json::Value &config) {
+    LOG_DEBUG << "PersonLoader initialized and Start";
+    maxBatch_ = config.get("max_batch", 100).asUInt();
+}
+
+void PersonLoaderPlugin::shutdown() {
+    LOG_DEBUG << "PersonLoader shut down";
+}
+
+auto PersonLoaderPlugin::load(std::string sql, int32_t id) -> Awaiter {
+    return Awaiter(*this, std::move(sql), id);
+}
+
+void PersonLoaderPlugin::enqueue(const std::string &sql, Waiter waiter) {
+    auto &batch = (*batches_)[sql];
+    batch.waiters.push_back(std::move(waiter));
+    if (batch.waiters.size() == 1) {
+        batch.generation = nextGeneration_++;
+        auto generation = batch.generation;
+        // queued functors run after the loop has handled every ready
+        // connection, so this picks up the rest of the iteration's lookups
+        trantor::EventLoop::getEventLoopOfCurrentThread()->queueInLoop([this, sql, generation]() {
+            flush(sql, generation);
+        });
+    }
+    if (batch.waiters.size() >= maxBatch_) flush(sql, batch.generation);
+}
+
+void PersonLoaderPlugin::flush(const std::string &sql, uint64_t generation) {
+    auto &pending = *batches_;
+    auto it = pending.find(sql);
+    // already sent because it filled up
+    if (it == pending.end() || it->second.generation != generation) return;
+    auto waiters = std::make_shared<std::vector<Waiter>>(std::move(it->second.waiters));
+    pending.erase(it);
+
+    std::vector<int32_t> ids;
+    ids.reserve(waiters->size());
+    for (const auto &waiter : *waiters) ids.push_back(waiter.id);
+
+    auto dbClientPtr = app().getDbClient();
+    *dbClientPtr << sql
+                 << toPgIntArray(ids)
+                 >> [waiters](const Result &result)
+                   {
+                      std::unordered_map<int32_t, std::size_t> rows;
+                      for (std::size_t i = 0; i < result.size(); ++i) {
+                          rows.emplace(result[i]["id"].as<int32_t>(), i);
+                      }
+                      for (const auto &waiter : *waiters) {
+                          auto row = rows.find(waiter.id);
+                          if (row == rows.end()) {
+                              waiter.done(std::nullopt, nullptr);
+                          } else {
+                              waiter.done(result[row->second], nullptr);
+                          }
+                      }
+                   }
+                 >> [waiters](const std::exception_ptr &error)
+                   {
+                      for (const auto &waiter : *waiters) waiter.done(std::nullopt, error);
+                   };
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <drogon/IOThreadStorage.h>
+#include <drogon/orm/Exception.h>
+#include <drogon/orm/Row.h>
+#include <drogon/plugins/Plugin.h>
+#include <drogon/utils/coroutine.h>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Coalesces single-person lookups. Lookups made on the same IO loop in the
+// same loop iteration, with the same statement, go to the database together
+// as one query once the iteration's requests have all been handled; each
+// caller gets back its own row. A lone lookup is sent without waiting.
+class PersonLoaderPlugin : public drogon::Plugin<PersonLoaderPlugin> {
+ public:
+    // Gives the row, or std::nullopt when no person has the id; a failed
+    // query is rethrown as its DrogonDbException.
+    class Awaiter : public drogon::CallbackAwaiter<std::optional<drogon::orm::Row>> {
+     public:
+        Awaiter(PersonLoaderPlugin &loader, std::string sql, int32_t id) : loader_(loader), sql_(std::move(sql)), id_(id) {}
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            loader_.enqueue(sql_, {id_, [this, handle](std::optional<drogon::orm::Row> row, const std::exception_ptr &error) {
+                if (error) setException(error); else setValue(std::move(row));
+                handle.resume();
+            }});
+        }
+
+     private:
+        PersonLoaderPlugin &loader_;
+        std::string sql_;
+        int32_t id_;
+    };
+
+    virtual void initAndStart(const Json::Value &config) override;
+    virtual void shutdown() override;
+
+    // sql takes the ids as $1::int[] and selects an id column. Must be
+    // awaited on an IO loop; resumes once the batch's query has returned.
+    auto load(std::string sql, int32_t id) -> Awaiter;
+
+ private:
+    struct Waiter {
+        int32_t id;
+        // error is set when the query failed
+        std::function<void(std::optional<drogon::orm::Row> row, const std::exception_ptr &error)> done;
+    };
+    struct Batch {
+        uint64_t generation{0};
+        std::vector<Waiter> waiters;
+    };
+
+    void enqueue(const std::string &sql, Waiter waiter);
+    void flush(const std::string &sql, uint64_t generation);
+
+    std::size_t maxBatch_{100};
+    std::atomic<uint64_t> nextGeneration_{1};
+    // pending batches of each IO loop, by statement
+    drogon::IOThreadStorage<std::unordered_map<std::string, Batch>> batches_;
+};
@@ -0,0 +1,205 @@
+#include "ReorgDraft.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+std::optional<int32_t> optionalInt(const Json::Value &json, const char *key) {
+    if (!json.isMember(key) || json[key].isNull()) return std::nullopt;
+    return json[key].asInt();
+}
+
+// keeps what map held at key the first time a batch touches it
+template <typename Map>
+void remember(std::unordered_map<int32_t, std::optional<typename Map::mapped_type>> &saved, const Map &map, int32_t key) {
+    if (saved.count(key)) return;
+    auto it = map.find(key);
+    saved.emplace(key, it == map.end() ? std::nullopt : std::optional<typename Map::mapped_type>{it->second});
+}
+
+template <typename Map>
+void restore(Map &map, std::unordered_map<int32_t, std::optional<typename Map::mapped_type>> &saved) {
+    for (auto &[key, value] : saved) {
+        if (value) map[key] = std::move(*value); else map.erase(key);
+    }
+}
+}  // namespace
+
+auto ReorgDraft::movesFromJson(const Json::Value &json, std::string &err) -> std::optional<std::vector<Move>> {
+    if (!json.isArray()) {
+        err = "expected an array of moves";
+        return std::nullopt;
+    }
+    std::vector<Move> moves;
+    moves.reserve(json.size());
+    try {
+        for (const auto &item : json) {
+            if (!item.isObject() || !item.isMember("id")) {
+                err = "every move needs an id";
+                return std::nullopt;
+            }
+            moves.push_back({item["id"].asInt(),
+                             optionalInt(item, "manager_id"),
+                             optionalInt(item, "department_id"),
+                             optionalInt(item, "job_id")});
+        }
+    } catch (const Json::Exception &e) {
+        err = e.what();
+        return std::nullopt;
+    }
+    return moves;
+}
+
+ReorgDraft::ReorgDraft(const OrgIndex &base) : baseVersion_{base.version()} {}
+
+auto ReorgDraft::placementOf(const OrgIndex &base, int32_t id) const -> Placement {
+    auto edit = edits_.find(id);
+    if (edit != edits_.end()) return edit->second;
+    const auto *entry = base.find(id);
+    return {base.managerOf(id).value_or(id), entry->departmentId, entry->jobId};
+}
+
+auto ReorgDraft::parentOf(const OrgIndex &base, int32_t id) const -> std::optional<int32_t> {
+    auto edit = edits_.find(id);
+    if (edit == edits_.end()) return base.managerOf(id);
+    if (edit->second.managerId == id) return std::nullopt;
+    return edit->second.managerId;
+}
+
+auto ReorgDraft::reportsOf(const OrgIndex &base, int32_t id) const -> std::vector<int32_t> {
+    std::vector<int32_t> ret;
+    for (auto report : base.reportsOf(id)) {
+        if (parentOf(base, report) == id) ret.push_back(report);
+    }
+    auto movedIn = movedIn_.find(id);
+    if (movedIn != movedIn_.end()) {
+        ret.insert(ret.end(), movedIn->second.begin(), movedIn->second.end());
+        std::sort(ret.begin(), ret.end());
+    }
+    return ret;
+}
+
+auto ReorgDraft::statsOf(const OrgIndex &base, int32_t id) const -> OrgIndex::Stats {
+    auto stats = *base.statsOf(id);
+    auto delta = delta_.find(id);
+    if (delta != delta_.end()) {
+        stats.headcount += delta->second.headcount;
+        OrgIndex::addCounts(stats.departments, delta->second.departments, 1);
+        OrgIndex::addCounts(stats.jobs, delta->second.jobs, 1);
+        stats.height = heightOf(base, id);
+    }
+    return stats;
+}
+
+// Only managers on a touched chain can have a different height than in the
+// base, so the recursion stops at the first untouched report.
+auto ReorgDraft::heightOf(const OrgIndex &base, int32_t id) const -> int32_t {
+    if (delta_.find(id) == delta_.end()) return base.statsOf(id)->height;
+    int32_t height = 0;
+    for (auto report : reportsOf(base, id)) height = std::max(height, heightOf(base, report) + 1);
+    return height;
+}
+
+void ReorgDraft::addToChain(const OrgIndex &base, std::optional<int32_t> from, const OrgIndex::Stats &delta, int sign) {
+    for (auto id = from; id; id = parentOf(base, *id)) {
+        if (undo_) remember(undo_->delta, delta_, *id);
+        auto &stats = delta_[*id];
+        stats.headcount += sign * delta.headcount;
+        OrgIndex::addCounts(stats.departments, delta.departments, sign);
+        OrgIndex::addCounts(stats.jobs, delta.jobs, sign);
+    }
+}
+
+auto ReorgDraft::applyOne(const OrgIndex &base, const Move &move, std::string &err) -> bool {
+    if (!base.contains(move.id)) {
+        err = "person " + std::to_string(move.id) + " not found";
+        return false;
+    }
+    auto current = placementOf(base, move.id);
+    auto next = Placement{move.managerId.value_or(current.managerId),
+                          move.departmentId.value_or(current.departmentId),
+                          move.jobId.value_or(current.jobId)};
+
+    auto oldParent = parentOf(base, move.id);
+    auto newParent = next.managerId == move.id ? std::nullopt : std::optional<int32_t>{next.managerId};
+    if (newParent && !base.contains(*newParent)) {
+        err = "manager " + std::to_string(*newParent) + " not found";
+        return false;
+    }
+    for (auto id = newParent; id; id = parentOf(base, *id)) {
+        if (*id == move.id) {
+            err = "moving person " + std::to_string(move.id) + " under " + std::to_string(*newParent) + " creates a cycle";
+            return false;
+        }
+    }
+
+    if (oldParent != newParent) {
+        auto stats = statsOf(base, move.id);
+        addToChain(base, oldParent, stats, -1);
+        if (oldParent) {
+            if (undo_) remember(undo_->movedIn, movedIn_, *oldParent);
+            auto &movedIn = movedIn_[*oldParent];
+            movedIn.erase(std::remove(movedIn.begin(), movedIn.end(), move.id), movedIn.end());
+        }
+        if (newParent && newParent != base.managerOf(move.id)) {
+            if (undo_) remember(undo_->movedIn, movedIn_, *newParent);
+            movedIn_[*newParent].push_back(move.id);
+        }
+        if (undo_) remember(undo_->edits, edits_, move.id);
+        edits_[move.id] = next;
+        addToChain(base, newParent, stats, 1);
+    }
+
+    if (next.departmentId != current.departmentId || next.jobId != current.jobId) {
+        OrgIndex::Stats before{1, 0, {{current.departmentId, 1}}, {{current.jobId, 1}}};
+        OrgIndex::Stats after{1, 0, {{next.departmentId, 1}}, {{next.jobId, 1}}};
+        addToChain(base, move.id, before, -1);
+        addToChain(base, move.id, after, 1);
+    }
+    if (undo_) remember(undo_->edits, edits_, move.id);
+    edits_[move.id] = next;
+    log_.push_back(move);
+    return true;
+}
+
+auto ReorgDraft::apply(const OrgIndex &base, const std::vector<Move> &moves, std::string &err) -> bool {
+    // applied in place; a bad move puts back what the batch overwrote, so
+    // a batch costs what it touches, not the size of the whole overlay
+    UndoLog undo;
+    undo_ = &undo;
+    auto logSize = log_.size();
+    auto applied = true;
+    for (const auto &move : moves) {
+        if (!applyOne(base, move, err)) {
+            applied = false;
+            break;
+        }
+    }
+    undo_ = nullptr;
+    if (!applied) {
+        restore(edits_, undo.edits);
+        restore(movedIn_, undo.movedIn);
+        restore(delta_, undo.delta);
+        log_.erase(log_.begin() + logSize, log_.end());
+    }
+    return applied;
+}
+
+auto ReorgDraft::rebase(const OrgIndex &base) -> std::vector<Move> {
+    auto log = std::move(log_);
+    *this = ReorgDraft(base);
+    std::vector<Move> dropped;
+    std::string err;
+    for (const auto &move : log) {
+        if (!applyOne(base, move, err)) dropped.push_back(move);
+    }
+    return dropped;
+}
+
+auto ReorgDraft::view(const OrgIndex &base, int32_t id) const -> std::optional<PersonView> {
+    if (!base.contains(id)) return std::nullopt;
+    auto placement = placementOf(base, id);
+    int depth = 0;
+    for (auto parent = parentOf(base, id); parent; parent = parentOf(base, *parent)) ++depth;
+    return PersonView{id, placement.managerId, placement.departmentId, placement.jobId, depth,
+                      reportsOf(base, id), statsOf(base, id)};
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <json/json.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "OrgIndex.h"
+
+// A hypothetical reorg layered over a live OrgIndex.
+//
+// The draft never copies the base: it keeps the placements that differ from
+// the base plus, for every manager on a chain touched by a move, the change
+// to that manager's aggregates. Memory is therefore proportional to
+// (moves * chain length). Everything else is read through from the base.
+//
+// All methods take the base the draft was opened on; once the base version
+// moves on, the overlay is stale and has to be rebased, which replays the
+// recorded moves against the current base.
+class ReorgDraft {
+ public:
+    struct Move {
+        int32_t id;
+        std::optional<int32_t> managerId;
+        std::optional<int32_t> departmentId;
+        std::optional<int32_t> jobId;
+    };
+
+    struct PersonView {
+        int32_t id;
+        int32_t managerId;
+        int32_t departmentId;
+        int32_t jobId;
+        int depth;
+        std::vector<int32_t> reports;
+        OrgIndex::Stats stats;
+    };
+
+    // Parses [{"id", "manager_id"?, "department_id"?, "job_id"?}, ...].
+    static auto movesFromJson(const Json::Value &json, std::string &err) -> std::optional<std::vector<Move>>;
+
+    explicit ReorgDraft(const OrgIndex &base);
+
+    auto baseVersion() const -> uint64_t { return baseVersion_; }
+    auto isStale(const OrgIndex &base) const -> bool { return base.version() != baseVersion_; }
+    auto moves() const -> const std::vector<Move> & { return log_; }
+
+    // Applies the batch in order. If any move is invalid (unknown person or
+    // manager, or a management cycle) nothing is applied and err says why.
+    auto apply(const OrgIndex &base, const std::vector<Move> &moves, std::string &err) -> bool;
+    // Replays the recorded moves on the current base and returns the ones
+    // that no longer apply.
+    auto rebase(const OrgIndex &base) -> std::vector<Move>;
+    auto view(const OrgIndex &base, int32_t id) const -> std::optional<PersonView>;
+
+ private:
+    struct Placement {
+        int32_t managerId;
+        int32_t departmentId;
+        int32_t jobId;
+    };
+
+    auto placementOf(const OrgIndex &base, int32_t id) const -> Placement;
+    auto parentOf(const OrgIndex &base, int32_t id) const -> std::optional<int32_t>;
+    auto reportsOf(const OrgIndex &base, int32_t id) const -> std::vector<int32_t>;
+    auto statsOf(const OrgIndex &base, int32_t id) const -> OrgIndex::Stats;
+    auto heightOf(const OrgIndex &base, int32_t id) const -> int32_t;
+    // The overlay entries a batch overwrote, as they were before it; empty
+    // for the ones it added. A failed apply() puts back only these.
+    struct UndoLog {
+        std::unordered_map<int32_t, std::optional<Placement>> edits;
+        std::unordered_map<int32_t, std::optional<std::vector<int32_t>>> movedIn;
+        std::unordered_map<int32_t, std::optional<OrgIndex::Stats>> delta;
+    };
+
+    auto applyOne(const OrgIndex &base, const Move &move, std::string &err) -> bool;
+    void addToChain(const OrgIndex &base, std::optional<int32_t> from, const OrgIndex::Stats &delta, int sign);
+
+    uint64_t baseVersion_;
+    std::vector<Move> log_;
+    std::unordered_map<int32_t, Placement> edits_;
+    // reports whose draft manager differs from their base manager, by draft manager
+    std::unordered_map<int32_t, std::vector<int32_t>> movedIn_;
+    // aggregate change per touched manager; height is recomputed, not stored
+    std::unordered_map<int32_t, OrgIndex::Stats> delta_;
+    // set while apply() runs
+    UndoLog *undo_{nullptr};
+};
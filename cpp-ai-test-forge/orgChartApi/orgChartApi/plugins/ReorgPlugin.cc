@@ -0,0 +1,44 @@
+#include "ReorgPlugin.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+
+using namespace drogon;
+
+void ReorgPlugin::initAndStart(const Json::Value &config) {
+    LOG_DEBUG << "Reorg initialized and Start";
+    maxDrafts_ = config.get("max_drafts", 64).asUInt();
+    orgIndex_ = app().getPlugin<OrgIndexPlugin>();
+}
+
+void ReorgPlugin::shutdown() {
+    LOG_DEBUG << "Reorg shut down";
+}
+
+auto ReorgPlugin::open() -> std::optional<int32_t> {
+    auto slot = orgIndex_->read([](const OrgIndex &index) { return std::make_shared<Slot>(index); });
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (drafts_.size() >= maxDrafts_) return std::nullopt;
+    auto draftId = nextId_++;
+    drafts_.emplace(draftId, std::move(slot));
+    return draftId;
+}
+
+auto ReorgPlugin::close(int32_t draftId) -> bool {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return drafts_.erase(draftId) > 0;
+}
+
+auto ReorgPlugin::ids() const -> std::vector<int32_t> {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<int32_t> ret;
+    ret.reserve(drafts_.size());
+    for (const auto &draft : drafts_) ret.push_back(draft.first);
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+auto ReorgPlugin::find(int32_t draftId) const -> std::shared_ptr<Slot> {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto draft = drafts_.find(draftId);
+    return draft == drafts_.end() ? nullptr : draft->second;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <drogon/plugins/Plugin.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "OrgIndexPlugin.h"
+#include "ReorgDraft.h"
+
+// Keeps the open reorg drafts. Drafts live in memory only and never touch
+// the person table; each one is locked on its own so planners working on
+// different drafts do not wait on each other.
+class ReorgPlugin : public drogon::Plugin<ReorgPlugin> {
+ public:
+    virtual void initAndStart(const Json::Value &config) override;
+    virtual void shutdown() override;
+
+    // Opens a draft on top of the current org; empty once max_drafts are open.
+    auto open() -> std::optional<int32_t>;
+    auto close(int32_t draftId) -> bool;
+    auto ids() const -> std::vector<int32_t>;
+
+    // Runs fn(ReorgDraft &, const OrgIndex &) with the draft locked and the
+    // index read-locked. Returns false if there is no such draft.
+    template <typename Fn>
+    auto with(int32_t draftId, Fn &&fn) -> bool {
+        auto slot = find(draftId);
+        if (!slot) return false;
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        orgIndex_->read([&slot, &fn](const OrgIndex &index) {
+            fn(slot->draft, index);
+            return true;
+        });
+        return true;
+    }
+
+ private:
+    struct Slot {
+        std::mutex mutex;
+        ReorgDraft draft;
+        explicit Slot(const OrgIndex &base) : draft{base} {}
+    };
+
+    auto find(int32_t draftId) const -> std::shared_ptr<Slot>;
+
+    OrgIndexPlugin *orgIndex_{nullptr};
+    std::size_t maxDrafts_{64};
+    mutable std::mutex mutex_;
+    int32_t nextId_{1};
+    std::unordered_map<int32_t, std::shared_ptr<Slot>> drafts_;
+};
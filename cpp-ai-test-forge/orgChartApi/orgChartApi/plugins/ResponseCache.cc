@@ -0,0 +1,50 @@
+#include "ResponseCache.h"
+#include <algorithm>
+#include <functional>
+
+ResponseCache::ResponseCache(std::size_t shards, std::size_t entriesPerShard)
+    : entriesPerShard_(std::max<std::size_t>(entriesPerShard, 1)), shards_(std::max<std::size_t>(shards, 1)) {}
+
+auto ResponseCache::find(const std::string &key, const std::string &etag) -> std::shared_ptr<const Entry> {
+    auto &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) return nullptr;
+    if (it->second.first->etag != etag) {
+        shard.order.erase(it->second.second);
+        shard.entries.erase(it);
+        return nullptr;
+    }
+    shard.order.splice(shard.order.begin(), shard.order, it->second.second);
+    return it->second.first;
+}
+
+void ResponseCache::insert(const std::string &key, std::shared_ptr<const Entry> entry) {
+    auto &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        it->second.first = std::move(entry);
+        shard.order.splice(shard.order.begin(), shard.order, it->second.second);
+        return;
+    }
+    if (shard.entries.size() >= entriesPerShard_) {
+        shard.entries.erase(shard.order.back());
+        shard.order.pop_back();
+    }
+    shard.order.push_front(key);
+    shard.entries.emplace(key, std::make_pair(std::move(entry), shard.order.begin()));
+}
+
+auto ResponseCache::size() const -> std::size_t {
+    std::size_t count = 0;
+    for (const auto &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        count += shard.entries.size();
+    }
+    return count;
+}
+
+auto ResponseCache::shardOf(const std::string &key) -> Shard & {
+    return shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Sharded LRU of finished response bodies. Every entry remembers the ETag
+// it was built at and a lookup with any other tag is a miss, so bumping a
+// table version is all it takes to invalidate what was built from it.
+class ResponseCache {
+ public:
+    struct Entry {
+        std::string etag;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+        // empty when the body was not worth compressing
+        std::string gzipped;
+    };
+
+    ResponseCache(std::size_t shards, std::size_t entriesPerShard);
+
+    // nullptr on a miss; an entry with a stale tag is dropped on the way
+    auto find(const std::string &key, const std::string &etag) -> std::shared_ptr<const Entry>;
+    void insert(const std::string &key, std::shared_ptr<const Entry> entry);
+    auto size() const -> std::size_t;
+
+ private:
+    struct Shard {
+        mutable std::mutex mutex;
+        // most recently used first
+        std::list<std::string> order;
+        std::unordered_map<std::string, std::pair<std::shared_ptr<const Entry>, std::list<std::string>::iterator>> entries;
+    };
+
+    auto shardOf(const std::string &key) -> Shard &;
+
+    std::size_t entriesPerShard_;
+    std::vector<Shard> shards_;
+};
@@ -0,0 +1,69 @@
+#include "ResponseCachePlugin.h"
+#include <drogon/drogon.h>
+#include <drogon/utils/Utilities.h>
+#include <algorithm>
+
+using namespace drogon;
+
+ResponseCachePlugin::Fill::Fill(ResponseCachePlugin &cache, std::string key, std::string etag)
+    : cache_(cache), key_(std::move(key)), etag_(std::move(etag)) {}
+
+void ResponseCachePlugin::Fill::keepHeaders(const HttpResponsePtr &resp) {
+    // the cached copy may go out gzipped or plain, so shared caches have to
+    // key on Accept-Encoding; kept with the other headers for the replays
+    resp->addHeader("Vary", "Accept-Encoding");
+    for (const auto &header : resp->headers()) headers_.push_back(header);
+}
+
+void ResponseCachePlugin::Fill::done(std::string body) {
+    if (body.size() > cache_.maxBodyBytes_) return;
+    auto entry = std::make_shared<ResponseCache::Entry>();
+    entry->etag = std::move(etag_);
+    entry->headers = std::move(headers_);
+    if (body.size() >= cache_.gzipMinBytes_) entry->gzipped = utils::gzipCompress(body.data(), body.size());
+    entry->body = std::move(body);
+    cache_.cache_->insert(key_, std::move(entry));
+}
+
+void ResponseCachePlugin::initAndStart(const Json::Value &config) {
+    LOG_DEBUG << "ResponseCache initialized and Start";
+    maxBodyBytes_ = config.get("max_body_bytes", 256 * 1024).asUInt();
+    gzipMinBytes_ = config.get("gzip_min_bytes", 1024).asUInt();
+    cache_ = std::make_unique<ResponseCache>(config.get("shards", 8).asUInt(), config.get("entries_per_shard", 256).asUInt());
+}
+
+void ResponseCachePlugin::shutdown() {
+    LOG_DEBUG << "ResponseCache shut down";
+}
+
+auto ResponseCachePlugin::keyOf(const HttpRequestPtr &req) -> std::string {
+    std::vector<std::pair<std::string, std::string>> params(req->getParameters().begin(), req->getParameters().end());
+    std::sort(params.begin(), params.end());
+    auto key = req->path();
+    for (const auto &[name, value] : params) {
+        key += key.size() == req->path().size() ? '?' : '&';
+        key += name + '=' + value;
+    }
+    return key;
+}
+
+auto ResponseCachePlugin::cached(const HttpRequestPtr &req, const std::string &key, const std::string &etag) -> HttpResponsePtr {
+    auto entry = cache_->find(key, etag);
+    if (!entry) return nullptr;
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setStatusCode(k200OK);
+    resp->setContentTypeCode(CT_APPLICATION_JSON);
+    for (const auto &[name, value] : entry->headers) resp->addHeader(name, value);
+    if (!entry->gzipped.empty() && req->getHeader("accept-encoding").find("gzip") != std::string::npos) {
+        // already compressed, so drogon leaves it alone
+        resp->addHeader("Content-Encoding", "gzip");
+        resp->setBody(entry->gzipped);
+    } else {
+        resp->setBody(entry->body);
+    }
+    return resp;
+}
+
+auto ResponseCachePlugin::fill(std::string key, std::string etag) -> std::shared_ptr<Fill> {
+    return std::make_shared<Fill>(*this, std::move(key), std::move(etag));
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
+#include <drogon/plugins/Plugin.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ResponseCache.h"
+
+// In-process cache of 200 JSON bodies for hot GET routes, keyed by path and
+// sorted query. Entries are tied to the ETag of the tables they were built
+// from (see TableVersionPlugin), so writes invalidate them without any
+// bookkeeping here. Bodies over gzip_min_bytes are also kept gzipped.
+class ResponseCachePlugin : public drogon::Plugin<ResponseCachePlugin> {
+ public:
+    // One response on its way into the cache.
+    class Fill {
+     public:
+        Fill(ResponseCachePlugin &cache, std::string key, std::string etag);
+
+        // Adds Vary: Accept-Encoding to resp and takes its headers to
+        // replay; call once resp has all the others.
+        void keepHeaders(const drogon::HttpResponsePtr &resp);
+        void done(std::string body);
+
+     private:
+        ResponseCachePlugin &cache_;
+        std::string key_;
+        std::string etag_;
+        std::vector<std::pair<std::string, std::string>> headers_;
+    };
+
+    virtual void initAndStart(const Json::Value &config) override;
+    virtual void shutdown() override;
+
+    static auto keyOf(const drogon::HttpRequestPtr &req) -> std::string;
+
+    // The cached response, or nullptr if key is not cached at etag.
+    auto cached(const drogon::HttpRequestPtr &req, const std::string &key, const std::string &etag) -> drogon::HttpResponsePtr;
+
+    auto fill(std::string key, std::string etag) -> std::shared_ptr<Fill>;
+    auto maxBodyBytes() const -> std::size_t { return maxBodyBytes_; }
+
+ private:
+    std::size_t maxBodyBytes_{256 * 1024};
+    std::size_t gzipMinBytes_{1024};
+    std::unique_ptr<ResponseCache> cache_;
+};
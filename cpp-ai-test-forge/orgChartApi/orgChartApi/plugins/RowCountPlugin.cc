@@ -0,0 +1,55 @@
+#include "RowCountPlugin.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+
+using namespace drogon;
+using namespace drogon::orm;
+
+void RowCountPlugin::initAndStart(const Json::Value &config) {
+    LOG_DEBUG << "RowCount initialized and Start";
+    interval_ = config.get("reconcile_interval", 60).asDouble();
+    // db clients are only usable once the main loop runs
+    app().getLoop()->queueInLoop([this]() { reconcile(); });
+    timerId_ = app().getLoop()->runEvery(interval_, [this]() { reconcile(); });
+}
+
+void RowCountPlugin::shutdown() {
+    LOG_DEBUG << "RowCount shut down";
+    app().getLoop()->invalidateTimer(timerId_);
+}
+
+auto RowCountPlugin::count(Table table) const -> int64_t {
+    return counts_[static_cast<std::size_t>(table)].load(std::memory_order_relaxed);
+}
+
+void RowCountPlugin::added(Table table) {
+    auto &rows = counts_[static_cast<std::size_t>(table)];
+    // before the first recount there is nothing to adjust
+    auto current = rows.load(std::memory_order_relaxed);
+    while (current >= 0 && !rows.compare_exchange_weak(current, current + 1, std::memory_order_relaxed)) {}
+}
+
+void RowCountPlugin::removed(Table table, int64_t rows) {
+    auto &counted = counts_[static_cast<std::size_t>(table)];
+    auto current = counted.load(std::memory_order_relaxed);
+    while (current >= 0 && !counted.compare_exchange_weak(current, std::max<int64_t>(current - rows, 0), std::memory_order_relaxed)) {}
+}
+
+void RowCountPlugin::reconcile() {
+    auto dbClientPtr = app().getDbClient();
+    *dbClientPtr << "select (select count(*) from person) as persons, \n\
+                            (select count(*) from department) as departments, \n\
+                            (select count(*) from job) as jobs"
+                 >> [this](const Result &result)
+                   {
+                      const auto &row = result[0];
+                      counts_[static_cast<std::size_t>(Table::Person)].store(row["persons"].as<int64_t>(), std::memory_order_relaxed);
+                      counts_[static_cast<std::size_t>(Table::Department)].store(row["departments"].as<int64_t>(), std::memory_order_relaxed);
+                      counts_[static_cast<std::size_t>(Table::Job)].store(row["jobs"].as<int64_t>(), std::memory_order_relaxed);
+                   }
+                 >> [](const DrogonDbException &e)
+                   {
+                      // keep serving the last counts; the next round retries
+                      LOG_ERROR << "RowCount recount failed: " << e.base().what();
+                   };
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <drogon/plugins/Plugin.h>
+#include <trantor/net/EventLoop.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Row counts of the person, department and job tables, for X-Total-Count.
+// Create and delete handlers adjust them as their writes succeed. They are
+// recounted once the event loop runs and every reconcile_interval seconds
+// after that, which also picks up writes made outside this process.
+class RowCountPlugin : public drogon::Plugin<RowCountPlugin> {
+ public:
+    enum class Table { Person, Department, Job };
+
+    virtual void initAndStart(const Json::Value &config) override;
+    virtual void shutdown() override;
+
+    // -1 until the first recount has finished
+    auto count(Table table) const -> int64_t;
+    void added(Table table);
+    void removed(Table table, int64_t rows = 1);
+
+ private:
+    void reconcile();
+
+    double interval_{60};
+    trantor::TimerId timerId_{0};
+    // indexed by Table
+    std::array<std::atomic<int64_t>, 3> counts_{{{-1}, {-1}, {-1}}};
+};
@@ -0,0 +1,26 @@
+#include "TableVersionPlugin.h"
+#include <drogon/drogon.h>
+#include <trantor/utils/Date.h>
+
+void TableVersionPlugin::initAndStart(const Json::Value &config) {
+    LOG_DEBUG << "TableVersion initialized and Start";
+    epoch_ = static_cast<uint64_t>(trantor::Date::now().microSecondsSinceEpoch());
+}
+
+void TableVersionPlugin::shutdown() {
+    LOG_DEBUG << "TableVersion shut down";
+}
+
+void TableVersionPlugin::changed(Table table) {
+    versions_[static_cast<std::size_t>(table)].fetch_add(1, std::memory_order_relaxed);
+}
+
+auto TableVersionPlugin::etag(std::initializer_list<Table> tables) const -> std::string {
+    auto tag = "W/\"" + std::to_string(epoch_);
+    for (auto table : tables) {
+        tag += '.';
+        tag += std::to_string(versions_[static_cast<std::size_t>(table)].load(std::memory_order_relaxed));
+    }
+    tag += '"';
+    return tag;
+}
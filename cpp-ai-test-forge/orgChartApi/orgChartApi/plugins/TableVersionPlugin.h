@@ -0,0 +1,31 @@
+#pragma once
+
+#include <drogon/plugins/Plugin.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include "RowCountPlugin.h"
+
+// Change versions of the person, department and job tables, for ETags. Write
+// handlers call changed() once a write has succeeded. Versions start from
+// the process start time, so tags handed out before a restart never match
+// after it. Writes made outside this process are not seen.
+class TableVersionPlugin : public drogon::Plugin<TableVersionPlugin> {
+ public:
+    using Table = RowCountPlugin::Table;
+
+    virtual void initAndStart(const Json::Value &config) override;
+    virtual void shutdown() override;
+
+    void changed(Table table);
+
+    // W/"..." over the versions of every table a response is built from
+    auto etag(std::initializer_list<Table> tables) const -> std::string;
+
+ private:
+    uint64_t epoch_{0};
+    // indexed by Table
+    std::array<std::atomic<uint64_t>, 3> versions_{};
+};
@@ -0,0 +1,53 @@
+#include "WorkerPool.h"
+#include <algorithm>
+#include <utility>
+
+WorkerPool::WorkerPool(std::size_t threads, std::size_t queueDepth)
+    : queueDepth_(std::max<std::size_t>(queueDepth, 1)) {
+    threads = std::max<std::size_t>(threads, 1);
+    threads_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) threads_.emplace_back([this]() { work(); });
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+auto WorkerPool::post(std::function<void()> job) -> bool {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || jobs_.size() >= queueDepth_) return false;
+        jobs_.push_back(std::move(job));
+    }
+    ready_.notify_one();
+    return true;
+}
+
+void WorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto &thread : threads_) thread.join();
+}
+
+auto WorkerPool::queued() const -> std::size_t {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size();
+}
+
+void WorkerPool::work() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        job();
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads for CPU heavy work that must stay off the IO loops.
+// At most queueDepth jobs wait; past that post() turns work away instead of
+// letting the backlog, and every caller's latency, grow without bound.
+class WorkerPool {
+ public:
+    WorkerPool(std::size_t threads, std::size_t queueDepth);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    // false, and job dropped, when the queue is full or the pool stopped
+    auto post(std::function<void()> job) -> bool;
+    // lets queued jobs finish, then joins the threads
+    void stop();
+    auto queued() const -> std::size_t;
+
+ private:
+    void work();
+
+    std::size_t queueDepth_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> jobs_;
+    bool stopping_{false};
+    std::vector<std::thread> threads_;
+};
@@ -22,6 +22,24 @@ CREATE TABLE person (
     CONSTRAINT fk_manager FOREIGN KEY(manager_id) REFERENCES person(id) ON DELETE SET NULL
 );
 
+-- /persons filters; each ends in id so a filtered page sorted by id is an
+-- index range scan. hire_date is UNIQUE and already indexed for its ranges.
+CREATE INDEX person_department_idx ON person (department_id, id);
+CREATE INDEX person_job_idx ON person (job_id, id);
+CREATE INDEX person_manager_idx ON person (manager_id, id);
+
+-- every (manager, report) pair at any distance, plus (person, person, 0)
+CREATE TABLE person_closure (
+    ancestor_id int NOT NULL,
+    descendant_id int NOT NULL,
+    depth int NOT NULL,
+    PRIMARY KEY (ancestor_id, descendant_id),
+    CONSTRAINT fk_ancestor FOREIGN KEY(ancestor_id) REFERENCES person(id) ON DELETE CASCADE,
+    CONSTRAINT fk_descendant FOREIGN KEY(descendant_id) REFERENCES person(id) ON DELETE CASCADE
+);
+
+CREATE INDEX person_closure_descendant_idx ON person_closure (descendant_id, depth);
+
 CREATE TABLE users (
     id SERIAL PRIMARY KEY,
     username VARCHAR(50) UNIQUE NOT NULL,
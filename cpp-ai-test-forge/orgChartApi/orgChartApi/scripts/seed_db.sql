@@ -22,5 +22,15 @@ INSERT INTO person(id, job_id, department_id, manager_id, first_name, last_name,
     (11, 4, 2, 8, 'Kaylie', 'Elyse', '2021-01-18'),
     (12, 4, 2, 8, 'Yancey', 'Trenton', '2022-03-02');
 
+INSERT INTO person_closure(ancestor_id, descendant_id, depth)
+    WITH RECURSIVE chain(ancestor_id, descendant_id, depth) AS (
+        SELECT id, id, 0 FROM person
+        UNION ALL
+        SELECT person.manager_id, chain.descendant_id, chain.depth + 1
+        FROM chain JOIN person ON person.id = chain.ancestor_id
+        WHERE person.manager_id <> person.id
+    )
+    SELECT ancestor_id, descendant_id, depth FROM chain;
+
 INSERT INTO users(id, username, password) VALUES
     (1, 'admin', 'password');
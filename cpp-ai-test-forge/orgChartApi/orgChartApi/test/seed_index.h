@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../plugins/OrgIndex.h"
+
+// same shape as scripts/seed_db.sql
+inline OrgIndex makeSeedIndex() {
+    return OrgIndex({
+        {1, 1, 1, 1, "Sabryna", "Peers"},
+        {2, 1, 1, 2, "Tayler", "Shantee"},
+        {3, 1, 1, 2, "Madonna", "Axl"},
+        {4, 2, 1, 4, "Marcia", "Stuart"},
+        {5, 2, 1, 3, "Cliff", "Rosalind"},
+        {6, 3, 1, 3, "Lake", "Philippa"},
+        {7, 3, 1, 3, "Wynne", "Walker"},
+        {8, 1, 2, 2, "Sterling", "Haley"},
+        {9, 8, 2, 2, "Melissa", "Garland"},
+        {10, 8, 2, 4, "Leon", "JayLee"},
+        {11, 8, 2, 4, "Kaylie", "Elyse"},
+        {12, 8, 2, 4, "Yancey", "Trenton"},
+    });
+}
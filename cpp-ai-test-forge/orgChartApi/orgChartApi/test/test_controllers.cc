@@ -19,6 +19,43 @@ DROGON_TEST(RemoteAPITest)
     });
 }
 
+DROGON_TEST(CreatePersonTest)
+{
+    // names and hire dates are unique, so each run makes its own
+    auto stamp = trantor::Date::now().microSecondsSinceEpoch();
+    Json::Value person;
+    person["job_id"] = 3;
+    person["department_id"] = 1;
+    person["manager_id"] = 2;
+    person["first_name"] = "First" + std::to_string(stamp);
+    person["last_name"] = "Last" + std::to_string(stamp);
+    person["hire_date"] = trantor::Date(1970, 1, 2).after(static_cast<double>(stamp % 40000) * 86400).toCustomedFormattedString("%Y-%m-%d");
+
+    auto client = drogon::HttpClient::newHttpClient("http://localhost:3000");
+    auto req = drogon::HttpRequest::newHttpJsonRequest(person);
+    req->setMethod(drogon::Post);
+    req->setPath("/persons");
+    // the insert and the closure rows commit together; a commit that never
+    // comes shows up as a timeout
+    client->sendRequest(req, [TEST_CTX, client](drogon::ReqResult res, const drogon::HttpResponsePtr& resp) {
+        REQUIRE(res == drogon::ReqResult::Ok);
+        REQUIRE(resp != nullptr);
+
+        CHECK(resp->getStatusCode() == drogon::k201Created);
+        auto created = resp->getJsonObject();
+        REQUIRE(created != nullptr);
+        REQUIRE((*created)["id"].isInt());
+
+        auto cleanup = drogon::HttpRequest::newHttpRequest();
+        cleanup->setMethod(drogon::Delete);
+        cleanup->setPath("/persons/" + std::to_string((*created)["id"].asInt()));
+        client->sendRequest(cleanup, [TEST_CTX](drogon::ReqResult res, const drogon::HttpResponsePtr& resp) {
+            REQUIRE(res == drogon::ReqResult::Ok);
+            CHECK(resp->getStatusCode() == drogon::k204NoContent);
+        }, 10);
+    }, 10);
+}
+
 // int main(int argc, char** argv)
 // {
 //     using namespace drogon;
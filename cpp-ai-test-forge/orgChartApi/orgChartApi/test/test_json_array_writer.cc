@@ -0,0 +1,38 @@
+#include <drogon/drogon_test.h>
+#include <string>
+#include "../utils/JsonArrayWriter.h"
+#include "../utils/JsonText.h"
+
+DROGON_TEST(JsonArrayWriterStreams)
+{
+    auto render = [](std::size_t count, std::size_t chunk) {
+        JsonArrayWriter writer(count, [](std::size_t i, std::string &out) {
+            out += "{\"id\":";
+            appendJsonInt(out, static_cast<int64_t>(i));
+            out += ",\"name\":";
+            appendJsonString(out, "p\"" + std::to_string(i) + "\n");
+            out += '}';
+        });
+        std::string out;
+        std::string buf(chunk, '\0');
+        while (auto len = writer.read(&buf[0], chunk)) out.append(buf, 0, len);
+        return out;
+    };
+
+    CHECK(render(0, 16) == "[]");
+    auto array = render(3, 4096);
+    CHECK(array == R"([{"id":0,"name":"p\"0\n"},{"id":1,"name":"p\"1\n"},{"id":2,"name":"p\"2\n"}])");
+    CHECK(render(3, 1) == array);
+
+    std::string finished;
+    auto element = [](std::size_t i, std::string &out) { appendJsonInt(out, static_cast<int64_t>(i)); };
+    JsonArrayWriter kept(3, element, [&finished](std::string text) { finished = std::move(text); });
+    char buf[2];
+    while (kept.read(buf, sizeof(buf))) {}
+    CHECK(finished == "[0,1,2]");
+
+    finished.clear();
+    JsonArrayWriter tooLong(3, element, [&finished](std::string text) { finished = std::move(text); }, 4);
+    while (tooLong.read(buf, sizeof(buf))) {}
+    CHECK(finished.empty());
+}
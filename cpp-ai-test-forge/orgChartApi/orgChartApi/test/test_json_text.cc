@@ -0,0 +1,28 @@
+#include <drogon/drogon_test.h>
+#include <json/json.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "../utils/JsonText.h"
+
+DROGON_TEST(JsonTextMatchesJsoncpp)
+{
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    builder["emitUTF8"] = true;
+    for (std::string text : {std::string{}, std::string{"plain"}, std::string{"q\"b\\s/\t\x01\x1f"}, std::string{"caf\xc3\xa9"}}) {
+        std::string out;
+        appendJsonString(out, text);
+        CHECK(out == Json::writeString(builder, Json::Value{text}));
+    }
+    for (int64_t value : {int64_t{0}, int64_t{-7}, int64_t{2147483647}, int64_t{-9223372036854775807} - 1}) {
+        std::string out;
+        appendJsonInt(out, value);
+        CHECK(out == Json::writeString(builder, Json::Value{static_cast<Json::Int64>(value)}));
+    }
+
+    std::string out;
+    appendJsonInt(out, std::shared_ptr<int32_t>{});
+    appendJsonString(out, std::make_shared<std::string>("x"));
+    CHECK(out == "null\"x\"");
+}
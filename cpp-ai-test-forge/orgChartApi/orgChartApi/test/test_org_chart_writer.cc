@@ -0,0 +1,34 @@
+#include <drogon/drogon_test.h>
+#include <memory>
+#include <string>
+#include "../plugins/OrgChartWriter.h"
+#include "../plugins/OrgLayout.h"
+#include "seed_index.h"
+
+DROGON_TEST(OrgChartWriterStreams)
+{
+    auto index = makeSeedIndex();
+    index.upsert({13, 8, 2, 4, "Ann & \"Bo\"", "<x>"});
+    auto layout = std::make_shared<const OrgLayout>(*OrgLayout::compute(index, 1));
+
+    auto render = [&layout](OrgChartWriter::Format format, std::size_t chunk) {
+        OrgChartWriter writer(layout, format);
+        std::string out;
+        std::string buf(chunk, '\0');
+        while (auto len = writer.read(&buf[0], chunk)) out.append(buf, 0, len);
+        return out;
+    };
+
+    auto svg = render(OrgChartWriter::Format::Svg, 4096);
+    CHECK(svg.rfind("<?xml", 0) == 0);
+    CHECK(svg.find("</svg>\n") == svg.size() - 7);
+    CHECK(svg.find(">Ann &amp; &quot;Bo&quot; &lt;x&gt;</text>") != std::string::npos);
+    CHECK(render(OrgChartWriter::Format::Svg, 7) == svg);
+
+    auto dot = render(OrgChartWriter::Format::Dot, 4096);
+    CHECK(dot.rfind("digraph org {", 0) == 0);
+    CHECK(dot.find("  n8 -> n13;\n") != std::string::npos);
+    CHECK(dot.find("[label=\"Ann & \\\"Bo\\\" <x>\"]") != std::string::npos);
+    CHECK(dot.find("-> n1;") == std::string::npos);
+    CHECK(render(OrgChartWriter::Format::Dot, 1) == dot);
+}
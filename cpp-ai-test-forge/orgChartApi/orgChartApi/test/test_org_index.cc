@@ -0,0 +1,90 @@
+#include <drogon/drogon_test.h>
+#include <vector>
+#include "../plugins/OrgIndex.h"
+#include "seed_index.h"
+
+DROGON_TEST(OrgIndexSubtree)
+{
+    auto index = makeSeedIndex();
+    CHECK(index.size() == 12);
+    CHECK((index.roots() == std::vector<int32_t>{1}));
+    CHECK((index.reportsOf(1) == std::vector<int32_t>{2, 3, 8}));
+
+    auto all = index.subtree(1);
+    CHECK(all.size() == 12);
+    CHECK(all[0].entry->id == 1);
+    CHECK(all.back().depth == 2);
+
+    auto topLevel = index.subtree(1, 1);
+    CHECK(topLevel.size() == 4);
+
+    CHECK(index.subtree(8).size() == 5);
+    CHECK(index.subtree(42).empty());
+}
+
+DROGON_TEST(OrgIndexBreaksCycles)
+{
+    OrgIndex index({
+        {1, 1, 1, 1, "a", "a"},
+        {2, 3, 1, 1, "b", "b"},
+        {3, 2, 1, 1, "c", "c"},
+    });
+    CHECK(index.roots().size() == 2);
+    CHECK(index.subtree(2).size() + index.subtree(3).size() == 3);
+}
+
+DROGON_TEST(OrgIndexChainAndCommonManager)
+{
+    auto index = makeSeedIndex();
+    CHECK(index.depthOf(10) == 2);
+    CHECK((index.chainOf(10) == std::vector<int32_t>{8, 1}));
+    CHECK(index.chainOf(1).empty());
+
+    CHECK(index.commonManager(10, 12) == 8);
+    CHECK(index.commonManager(4, 7) == 1);
+    CHECK(index.commonManager(9, 8) == 8);
+    CHECK(index.commonManager(5, 5) == 5);
+    CHECK(!index.commonManager(5, 42));
+}
+
+DROGON_TEST(OrgIndexIncrementalUpdates)
+{
+    auto index = makeSeedIndex();
+    auto version = index.version();
+
+    // move Sterling's org under Madonna
+    CHECK(index.upsert({8, 3, 2, 2, "Sterling", "Haley"}));
+    CHECK(index.version() > version);
+    CHECK(index.depthOf(10) == 3);
+    CHECK(index.commonManager(10, 6) == 3);
+    CHECK((index.reportsOf(3) == std::vector<int32_t>{6, 7, 8}));
+
+    // no one can report to their own subtree
+    CHECK(!index.upsert({3, 10, 1, 2, "Madonna", "Axl"}));
+    CHECK(index.depthOf(3) == 1);
+
+    CHECK(index.upsert({13, 10, 2, 3, "New", "Hire"}));
+    CHECK(index.depthOf(13) == 4);
+    CHECK(index.subtree(8).size() == 6);
+
+    CHECK(index.remove(13));
+    CHECK(!index.contains(13));
+    CHECK(index.size() == 12);
+    CHECK(index.subtree(1).size() == 12);
+}
+
+DROGON_TEST(OrgIndexStats)
+{
+    auto index = makeSeedIndex();
+    const auto *top = index.statsOf(1);
+    CHECK(top->headcount == 12);
+    CHECK(top->height == 2);
+    CHECK((top->departments == OrgIndex::Counts{{1, 7}, {2, 5}}));
+
+    CHECK(index.upsert({10, 2, 2, 4, "Leon", "JayLee"}));
+    CHECK(index.statsOf(8)->headcount == 4);
+    CHECK(index.statsOf(2)->headcount == 4);
+    CHECK(index.statsOf(2)->height == 1);
+    CHECK((index.statsOf(2)->departments == OrgIndex::Counts{{1, 3}, {2, 1}}));
+    CHECK(index.statsOf(1)->headcount == 12);
+}
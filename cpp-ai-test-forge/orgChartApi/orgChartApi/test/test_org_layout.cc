@@ -0,0 +1,33 @@
+#include <drogon/drogon_test.h>
+#include <unordered_map>
+#include "../plugins/OrgLayout.h"
+#include "seed_index.h"
+
+DROGON_TEST(OrgLayoutTidyTree)
+{
+    auto index = makeSeedIndex();
+    auto layout = OrgLayout::compute(index, 1);
+    REQUIRE(layout.has_value());
+    CHECK(layout->nodes.size() == 12);
+    CHECK(layout->width == 7);
+    CHECK(layout->height == 2);
+
+    std::unordered_map<int32_t, double> x;
+    for (const auto &node : layout->nodes) x[node.id] = node.x;
+    // leaves pack left to right, managers centre over their reports
+    CHECK(x[4] == 0);
+    CHECK(x[7] == 3);
+    CHECK(x[12] == 7);
+    CHECK(x[2] == 0.5);
+    CHECK(x[3] == 2.5);
+    CHECK(x[8] == 5.5);
+    CHECK(x[1] == 3);
+    CHECK(layout->nodes[0].managerId == 1);
+    CHECK(layout->nodes.back().y == 2);
+
+    auto division = OrgLayout::compute(index, 8);
+    REQUIRE(division.has_value());
+    CHECK(division->nodes.size() == 5);
+    CHECK(division->nodes[0].x == 1.5);
+    CHECK(!OrgLayout::compute(index, 42));
+}
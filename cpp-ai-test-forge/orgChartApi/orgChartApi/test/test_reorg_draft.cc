@@ -0,0 +1,37 @@
+#include <drogon/drogon_test.h>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../plugins/ReorgDraft.h"
+#include "seed_index.h"
+
+DROGON_TEST(ReorgDraftOverlay)
+{
+    auto index = makeSeedIndex();
+    ReorgDraft draft(index);
+
+    std::string err;
+    CHECK(draft.apply(index, {{8, 2, std::nullopt, std::nullopt}, {6, std::nullopt, 2, std::nullopt}}, err));
+    auto tayler = draft.view(index, 2);
+    CHECK(tayler->stats.headcount == 8);
+    CHECK(tayler->stats.height == 2);
+    CHECK((tayler->reports == std::vector<int32_t>{4, 5, 8}));
+    CHECK(draft.view(index, 10)->depth == 3);
+    CHECK((draft.view(index, 3)->stats.departments == OrgIndex::Counts{{1, 2}, {2, 1}}));
+
+    // the base is untouched
+    CHECK(index.statsOf(2)->headcount == 3);
+
+    // a batch with a cycle is rejected as a whole
+    CHECK(!draft.apply(index, {{4, 3, std::nullopt, std::nullopt}, {2, 10, std::nullopt, std::nullopt}}, err));
+    CHECK(draft.moves().size() == 2);
+    CHECK(draft.view(index, 4)->managerId == 2);
+    CHECK(draft.view(index, 2)->stats.headcount == 8);
+    CHECK((draft.view(index, 3)->reports == std::vector<int32_t>{6, 7}));
+    CHECK((draft.view(index, 3)->stats.departments == OrgIndex::Counts{{1, 2}, {2, 1}}));
+
+    CHECK(index.upsert({12, 9, 2, 4, "Yancey", "Trenton"}));
+    CHECK(draft.isStale(index));
+    CHECK(draft.rebase(index).empty());
+    CHECK(draft.view(index, 9)->stats.headcount == 2);
+}
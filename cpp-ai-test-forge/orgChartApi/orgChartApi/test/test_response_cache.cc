@@ -0,0 +1,41 @@
+#include <drogon/drogon_test.h>
+#include <memory>
+#include <string>
+#include "../plugins/ResponseCache.h"
+
+DROGON_TEST(ResponseCacheLru)
+{
+    auto entry = [](const std::string &etag, const std::string &body) {
+        auto ret = std::make_shared<ResponseCache::Entry>();
+        ret->etag = etag;
+        ret->body = body;
+        return std::shared_ptr<const ResponseCache::Entry>(ret);
+    };
+
+    // one shard, so eviction order is easy to follow
+    ResponseCache cache(1, 2);
+    cache.insert("/jobs", entry("v1", "a"));
+    cache.insert("/departments", entry("v1", "b"));
+    REQUIRE(cache.find("/jobs", "v1") != nullptr);
+    CHECK(cache.find("/jobs", "v1")->body == "a");
+
+    // /departments is now the least recently used
+    cache.insert("/persons", entry("v1", "c"));
+    CHECK(cache.find("/departments", "v1") == nullptr);
+    CHECK(cache.find("/persons", "v1") != nullptr);
+    CHECK(cache.size() == 2);
+
+    // a newer table version misses and drops the entry
+    CHECK(cache.find("/jobs", "v2") == nullptr);
+    CHECK(cache.find("/jobs", "v1") == nullptr);
+    CHECK(cache.size() == 1);
+
+    cache.insert("/persons", entry("v2", "d"));
+    CHECK(cache.find("/persons", "v2")->body == "d");
+    CHECK(cache.size() == 1);
+
+    ResponseCache sharded(8, 4);
+    for (int i = 0; i < 100; ++i) sharded.insert("/persons/" + std::to_string(i), entry("v1", std::to_string(i)));
+    CHECK(sharded.size() <= 32);
+    CHECK(sharded.find("/persons/99", "v1")->body == "99");
+}
@@ -0,0 +1,31 @@
+#include <drogon/drogon_test.h>
+#include <atomic>
+#include <future>
+#include "../plugins/WorkerPool.h"
+
+DROGON_TEST(WorkerPoolBounded)
+{
+    std::atomic<int> ran{0};
+    std::promise<void> started;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    // one thread held busy, so the queue fills up behind it
+    WorkerPool pool(1, 2);
+    CHECK(pool.post([&started, released, &ran]() {
+        started.set_value();
+        released.wait();
+        ++ran;
+    }));
+    started.get_future().wait();
+    CHECK(pool.post([&ran]() { ++ran; }));
+    CHECK(pool.post([&ran]() { ++ran; }));
+    CHECK(pool.queued() == 2);
+    CHECK(!pool.post([&ran]() { ++ran; }));
+
+    // stopping finishes what was queued and turns the rest away
+    release.set_value();
+    pool.stop();
+    CHECK(ran == 3);
+    CHECK(!pool.post([&ran]() { ++ran; }));
+}
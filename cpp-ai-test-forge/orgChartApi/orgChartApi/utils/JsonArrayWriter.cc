@@ -0,0 +1,42 @@
+#include "JsonArrayWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+JsonArrayWriter::JsonArrayWriter(std::size_t count, Element element, Finished finished, std::size_t finishedLimit)
+    : count_(count), element_(std::move(element)), finished_(std::move(finished)), finishedLimit_(finishedLimit) {}
+
+auto JsonArrayWriter::read(char *buf, std::size_t len) -> std::size_t {
+    std::size_t written = 0;
+    while (written < len) {
+        if (pendingPos_ == pending_.size()) {
+            pending_.clear();
+            pendingPos_ = 0;
+            if (stage_ == Stage::Done) break;
+            if (stage_ == Stage::Open) {
+                pending_ = "[";
+                stage_ = Stage::Elements;
+            } else if (stage_ == Stage::Elements && next_ < count_) {
+                if (next_ > 0) pending_ += ',';
+                element_(next_++, pending_);
+            } else {
+                pending_ = "]";
+                stage_ = Stage::Done;
+            }
+            if (finished_) {
+                if (text_.size() + pending_.size() > finishedLimit_) {
+                    finished_ = nullptr;
+                    std::string{}.swap(text_);
+                } else {
+                    text_ += pending_;
+                    if (stage_ == Stage::Done) finished_(std::move(text_));
+                }
+            }
+        }
+        auto count = std::min(len - written, pending_.size() - pendingPos_);
+        std::memcpy(buf + written, pending_.data() + pendingPos_, count);
+        pendingPos_ += count;
+        written += count;
+    }
+    return written;
+}
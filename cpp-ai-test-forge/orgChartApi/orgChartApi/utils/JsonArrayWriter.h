@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <string>
+
+// Writes a JSON array one element at a time, for use as a stream response
+// body. Elements are written when they are reached, so only the text of
+// the current one is ever held, in a buffer reused for every element.
+class JsonArrayWriter {
+ public:
+    // appends the JSON text of element i to out
+    using Element = std::function<void(std::size_t i, std::string &out)>;
+
+    // gets the whole array once its last byte has been read, unless it grew
+    // past the limit on the way
+    using Finished = std::function<void(std::string text)>;
+
+    JsonArrayWriter(std::size_t count, Element element, Finished finished = nullptr,
+                    std::size_t finishedLimit = std::numeric_limits<std::size_t>::max());
+
+    // Copies up to len bytes of the array into buf; 0 once it is done.
+    auto read(char *buf, std::size_t len) -> std::size_t;
+
+ private:
+    enum class Stage { Open, Elements, Close, Done };
+
+    std::size_t count_;
+    Element element_;
+    Finished finished_;
+    std::size_t finishedLimit_;
+    std::string text_;
+    Stage stage_{Stage::Open};
+    std::size_t next_{0};
+    std::string pending_;
+    std::size_t pendingPos_{0};
+};
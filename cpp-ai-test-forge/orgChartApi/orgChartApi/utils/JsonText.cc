@@ -0,0 +1,51 @@
+#include "JsonText.h"
+#include <charconv>
+
+void appendJsonString(std::string &out, std::string_view text) {
+    static const char *kHex = "0123456789abcdef";
+    out += '"';
+    auto clean = text.begin();
+    for (auto it = text.begin(); it != text.end(); ++it) {
+        auto c = static_cast<unsigned char>(*it);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.append(clean, it);
+        clean = it + 1;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                out += "\\u00";
+                out += kHex[c >> 4];
+                out += kHex[c & 0xf];
+        }
+    }
+    out.append(clean, text.end());
+    out += '"';
+}
+
+void appendJsonInt(std::string &out, int64_t value) {
+    char buf[24];
+    auto end = std::to_chars(buf, buf + sizeof(buf), value).ptr;
+    out.append(buf, end);
+}
+
+void appendJsonInt(std::string &out, const std::shared_ptr<int32_t> &value) {
+    if (value) {
+        appendJsonInt(out, *value);
+    } else {
+        out += "null";
+    }
+}
+
+void appendJsonString(std::string &out, const std::shared_ptr<std::string> &value) {
+    if (value) {
+        appendJsonString(out, *value);
+    } else {
+        out += "null";
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Appends JSON text straight into a caller-owned buffer, for bodies that
+// would otherwise be built as a Json::Value tree and then serialised.
+
+void appendJsonString(std::string &out, std::string_view text);
+void appendJsonInt(std::string &out, int64_t value);
+
+// null for an unset column, like the generated toJson()
+void appendJsonInt(std::string &out, const std::shared_ptr<int32_t> &value);
+void appendJsonString(std::string &out, const std::shared_ptr<std::string> &value);
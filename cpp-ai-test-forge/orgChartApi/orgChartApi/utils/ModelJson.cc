@@ -0,0 +1,106 @@
+#include "ModelJson.h"
+#include "JsonText.h"
+
+using namespace drogon_model::org_chart;
+
+namespace {
+void appendDate(std::string &out, const std::shared_ptr<trantor::Date> &date) {
+    if (date) {
+        appendJsonString(out, date->toDbStringLocal());
+    } else {
+        out += "null";
+    }
+}
+}  // namespace
+
+void appendJson(std::string &out, const Department &department) {
+    out += "{\"id\":";
+    appendJsonInt(out, department.getId());
+    out += ",\"name\":";
+    appendJsonString(out, department.getName());
+    out += '}';
+}
+
+void appendJson(std::string &out, const Job &job) {
+    out += "{\"id\":";
+    appendJsonInt(out, job.getId());
+    out += ",\"title\":";
+    appendJsonString(out, job.getTitle());
+    out += '}';
+}
+
+void appendJson(std::string &out, const Person &person) {
+    out += "{\"department_id\":";
+    appendJsonInt(out, person.getDepartmentId());
+    out += ",\"first_name\":";
+    appendJsonString(out, person.getFirstName());
+    out += ",\"hire_date\":";
+    appendDate(out, person.getHireDate());
+    out += ",\"id\":";
+    appendJsonInt(out, person.getId());
+    out += ",\"job_id\":";
+    appendJsonInt(out, person.getJobId());
+    out += ",\"last_name\":";
+    appendJsonString(out, person.getLastName());
+    out += ",\"manager_id\":";
+    appendJsonInt(out, person.getManagerId());
+    out += '}';
+}
+
+void appendJson(std::string &out, const PersonInfo &personInfo, unsigned fields) {
+    // '{' before the first member, ',' before the rest
+    auto separator = '{';
+    if (fields & kPersonDepartment) {
+        out += separator;
+        out += "\"department\":{\"id\":";
+        appendJsonInt(out, personInfo.getValueOfDepartmentId());
+        out += ",\"name\":";
+        appendJsonString(out, personInfo.getValueOfDepartmentName());
+        out += '}';
+        separator = ',';
+    }
+    if (fields & kPersonFirstName) {
+        out += separator;
+        out += "\"first_name\":";
+        appendJsonString(out, personInfo.getValueOfFirstName());
+        separator = ',';
+    }
+    if (fields & kPersonHireDate) {
+        out += separator;
+        out += "\"hire_date\":";
+        appendJsonString(out, personInfo.getValueOfHireDate().toDbStringLocal());
+        separator = ',';
+    }
+    if (fields & kPersonId) {
+        out += separator;
+        out += "\"id\":";
+        appendJsonInt(out, personInfo.getValueOfId());
+        separator = ',';
+    }
+    if (fields & kPersonJob) {
+        out += separator;
+        out += "\"job\":{\"id\":";
+        appendJsonInt(out, personInfo.getValueOfJobId());
+        out += ",\"title\":";
+        appendJsonString(out, personInfo.getValueOfJobTitle());
+        out += '}';
+        separator = ',';
+    }
+    if (fields & kPersonLastName) {
+        out += separator;
+        out += "\"last_name\":";
+        appendJsonString(out, personInfo.getValueOfLastName());
+        separator = ',';
+    }
+    if (fields & kPersonManager) {
+        out += separator;
+        out += "\"manager\":{\"full_name\":";
+        appendJsonString(out, personInfo.getValueOfManagerFullName());
+        out += ",\"id\":";
+        appendJsonInt(out, personInfo.getValueOfManagerId());
+        out += '}';
+        separator = ',';
+    }
+    if (separator == '{') out += '{';
+    out += '}';
+}
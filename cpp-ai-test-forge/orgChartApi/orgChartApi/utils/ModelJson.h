@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include "../models/Department.h"
+#include "../models/Job.h"
+#include "../models/Person.h"
+#include "../models/PersonInfo.h"
+
+// Model bodies written straight into a reusable buffer. Same fields and key
+// order as the Json::Value the controllers used to build.
+
+void appendJson(std::string &out, const drogon_model::org_chart::Department &department);
+void appendJson(std::string &out, const drogon_model::org_chart::Job &job);
+void appendJson(std::string &out, const drogon_model::org_chart::Person &person);
+
+// members of the /persons shape, for narrowing it with ?fields=
+enum PersonInfoField : unsigned {
+    kPersonId = 1u << 0,
+    kPersonFirstName = 1u << 1,
+    kPersonLastName = 1u << 2,
+    kPersonHireDate = 1u << 3,
+    kPersonManager = 1u << 4,
+    kPersonDepartment = 1u << 5,
+    kPersonJob = 1u << 6,
+    kPersonAllFields = (1u << 7) - 1,
+};
+
+// the /persons shape, with manager, department and job nested; only the
+// members in fields are written
+void appendJson(std::string &out, const drogon_model::org_chart::PersonInfo &personInfo, unsigned fields = kPersonAllFields);
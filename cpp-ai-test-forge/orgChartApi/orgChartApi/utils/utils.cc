@@ -1,12 +1,19 @@
 #include "utils.h"
+#include "ModelJson.h"
+#include "../models/Person.h"
+#include <drogon/utils/Utilities.h>
+#include <algorithm>
+#include <limits>
 
 void badRequest(std::function<void(const drogon::HttpResponsePtr &)> &&callback, std::string err, drogon::HttpStatusCode code)
 {
-    Json::Value ret{};
-    ret["error"] = err;
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(ret);
+    callback(newErrResponse(std::move(err), code));
+}
+
+drogon::HttpResponsePtr newErrResponse(std::string err, drogon::HttpStatusCode code) {
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(makeErrResp(std::move(err)));
     resp->setStatusCode(code);
-    callback(resp);
+    return resp;
 }
 
 Json::Value makeErrResp(std::string err) {
@@ -14,3 +21,205 @@ Json::Value makeErrResp(std::string err) {
     ret["error"] = err;
     return ret;
 }
+
+drogon::HttpResponsePtr notModifiedResponse(const drogon::HttpRequestPtr &req, const std::string &etag) {
+    const auto &ifNoneMatch = req->getHeader("if-none-match");
+    if (ifNoneMatch.empty()) return nullptr;
+    // weak comparison: W/ prefixes do not matter
+    auto opaque = [](std::string tag) {
+        tag.erase(0, tag.find_first_not_of(" \t"));
+        tag.erase(tag.find_last_not_of(" \t") + 1);
+        if (tag.rfind("W/", 0) == 0) tag.erase(0, 2);
+        return tag;
+    };
+    auto wanted = opaque(etag);
+    std::size_t start = 0;
+    auto matched = false;
+    while (!matched && start <= ifNoneMatch.size()) {
+        auto end = std::min(ifNoneMatch.find(',', start), ifNoneMatch.size());
+        auto tag = opaque(ifNoneMatch.substr(start, end - start));
+        matched = tag == "*" || tag == wanted;
+        start = end + 1;
+    }
+    if (!matched) return nullptr;
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setStatusCode(drogon::k304NotModified);
+    resp->addHeader("ETag", etag);
+    return resp;
+}
+
+void addTotalCountHeader(const drogon::HttpResponsePtr &resp, RowCountPlugin::Table table) {
+    auto total = drogon::app().getPlugin<RowCountPlugin>()->count(table);
+    if (total >= 0) resp->addHeader("X-Total-Count", std::to_string(total));
+}
+
+drogon::HttpResponsePtr newJsonArrayStreamResponse(std::size_t count, JsonArrayWriter::Element element) {
+    return newJsonArrayStreamResponse(count, std::move(element), nullptr);
+}
+
+drogon::HttpResponsePtr newJsonArrayStreamResponse(std::size_t count, JsonArrayWriter::Element element, std::shared_ptr<ResponseCachePlugin::Fill> fill) {
+    JsonArrayWriter::Finished finished;
+    auto finishedLimit = std::numeric_limits<std::size_t>::max();
+    if (fill) {
+        finished = [fill](std::string text) { fill->done(std::move(text)); };
+        finishedLimit = drogon::app().getPlugin<ResponseCachePlugin>()->maxBodyBytes();
+    }
+    auto writer = std::make_shared<JsonArrayWriter>(count, std::move(element), std::move(finished), finishedLimit);
+    auto resp = drogon::HttpResponse::newStreamResponse(
+        [writer](char *buf, std::size_t len) -> std::size_t {
+            // a null buffer means the client went away
+            return buf ? writer->read(buf, len) : 0;
+        },
+        "",
+        drogon::CT_APPLICATION_JSON);
+    resp->setStatusCode(drogon::k200OK);
+    return resp;
+}
+
+Json::Value countsToJson(const std::vector<std::pair<int32_t, int32_t>> &counts) {
+    Json::Value ret{Json::arrayValue};
+    for (const auto &item : counts) {
+        Json::Value count{};
+        count["id"] = item.first;
+        count["headcount"] = item.second;
+        ret.append(count);
+    }
+    return ret;
+}
+
+std::string toPgIntArray(const std::vector<int32_t> &values) {
+    std::string ret{"{"};
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) ret += ',';
+        ret += std::to_string(values[i]);
+    }
+    ret += '}';
+    return ret;
+}
+
+std::string toPgIntArray(const std::vector<std::optional<int32_t>> &values) {
+    std::string ret{"{"};
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) ret += ',';
+        ret += values[i] ? std::to_string(*values[i]) : "NULL";
+    }
+    ret += '}';
+    return ret;
+}
+
+void bindJsonValue(drogon::orm::internal::SqlBinder &binder, const Json::Value &value) {
+    switch (value.type()) {
+    case Json::nullValue:
+        binder << nullptr;
+        break;
+    case Json::booleanValue:
+        binder << value.asBool();
+        break;
+    case Json::intValue:
+    case Json::uintValue:
+        binder << static_cast<int64_t>(value.asInt64());
+        break;
+    case Json::realValue:
+        binder << value.asDouble();
+        break;
+    case Json::stringValue:
+        binder << value.asString();
+        break;
+    default:
+        binder << value.toStyledString();
+        break;
+    }
+}
+
+std::optional<int> pageLimitOf(const drogon::HttpRequestPtr &req, int fallback) {
+    auto limit = req->getOptionalParameter<int>("limit").value_or(fallback);
+    if (limit < 0) return std::nullopt;
+    return std::min(limit, kMaxPageLimit);
+}
+
+std::optional<int> pageOffsetOf(const drogon::HttpRequestPtr &req) {
+    auto offset = req->getOptionalParameter<int>("offset").value_or(0);
+    if (offset < 0) return std::nullopt;
+    return offset;
+}
+
+// fields are newline separated; the key goes last since it may contain anything
+std::string encodeCursor(const PageCursor &cursor) {
+    auto plain = cursor.sortField + '\n' + cursor.sortOrder + '\n' + std::to_string(cursor.id) + '\n' + cursor.key;
+    return drogon::utils::base64Encode(reinterpret_cast<const unsigned char *>(plain.data()), plain.size(), true);
+}
+
+std::optional<PageCursor> decodeCursor(const std::string &token) {
+    auto encoded = token;
+    std::replace(encoded.begin(), encoded.end(), '-', '+');
+    std::replace(encoded.begin(), encoded.end(), '_', '/');
+    auto plain = drogon::utils::base64Decode(encoded);
+
+    auto first = plain.find('\n');
+    auto second = first == std::string::npos ? first : plain.find('\n', first + 1);
+    auto third = second == std::string::npos ? second : plain.find('\n', second + 1);
+    if (third == std::string::npos) return std::nullopt;
+
+    PageCursor cursor;
+    cursor.sortField = plain.substr(0, first);
+    cursor.sortOrder = plain.substr(first + 1, second - first - 1);
+    try {
+        std::size_t used = 0;
+        auto idText = plain.substr(second + 1, third - second - 1);
+        cursor.id = std::stoi(idText, &used);
+        if (used != idText.size()) return std::nullopt;
+    } catch (const std::exception &) {
+        return std::nullopt;
+    }
+    cursor.key = plain.substr(third + 1);
+    return cursor;
+}
+
+drogon::Task<drogon::HttpResponsePtr> getPersonsOf(drogon::HttpRequestPtr req,
+                                                   RowCountPlugin::Table parentTable,
+                                                   std::string parentTableName,
+                                                   std::string foreignKey,
+                                                   int parentId) {
+    using drogon_model::org_chart::Person;
+    auto etag = drogon::app().getPlugin<TableVersionPlugin>()->etag({parentTable, TableVersionPlugin::Table::Person});
+    if (auto resp = notModifiedResponse(req, etag)) co_return resp;
+    auto limit = pageLimitOf(req);
+    if (!limit) co_return newErrResponse("limit must not be negative");
+    auto after = std::numeric_limits<int32_t>::min();
+    if (auto token = req->getOptionalParameter<std::string>("cursor")) {
+        auto cursor = decodeCursor(*token);
+        if (!cursor || cursor->sortField != Person::Cols::_id) co_return newErrResponse("invalid cursor");
+        after = cursor->id;
+    }
+
+    // no rows: no parent; one row of nulls: a parent without persons
+    auto sql = "select person.* from " + parentTableName + " as parent \n\
+                left join lateral (select * from person \n\
+                                   where person." + foreignKey + " = parent.id and person.id > $2 \n\
+                                   order by person.id limit $3) as person on true \n\
+                where parent.id = $1";
+    drogon::orm::Result result(nullptr);
+    try {
+        result = co_await drogon::app().getDbClient()->execSqlCoro(sql, parentId, after, *limit);
+    } catch (const drogon::orm::DrogonDbException &e) {
+        LOG_ERROR << e.base().what();
+        co_return newErrResponse("database error", drogon::k500InternalServerError);
+    }
+    if (result.empty()) co_return newErrResponse("resource not found", drogon::k404NotFound);
+
+    auto persons = std::make_shared<std::vector<Person>>();
+    if (!result[0][Person::Cols::_id].isNull()) {
+        persons->reserve(result.size());
+        for (const auto &row : result) persons->emplace_back(row);
+    }
+    auto resp = newJsonArrayStreamResponse(persons->size(), [persons](std::size_t i, std::string &out) {
+        appendJson(out, (*persons)[i]);
+    });
+    resp->addHeader("ETag", etag);
+    // a short page is the last one
+    if (!persons->empty() && persons->size() == static_cast<std::size_t>(*limit)) {
+        auto lastId = persons->back().getValueOfId();
+        resp->addHeader("X-Next-Cursor", encodeCursor({Person::Cols::_id, "asc", lastId, std::to_string(lastId)}));
+    }
+    co_return resp;
+}
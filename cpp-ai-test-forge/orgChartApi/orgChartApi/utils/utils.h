@@ -1,6 +1,17 @@
 #pragma once
 
 #include <drogon/drogon.h>
+#include <drogon/utils/coroutine.h>
+#include "JsonArrayWriter.h"
+#include "../plugins/ResponseCachePlugin.h"
+#include "../plugins/RowCountPlugin.h"
+#include "../plugins/TableVersionPlugin.h"
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 void badRequest (
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
@@ -9,3 +20,103 @@ void badRequest (
 );
 
 Json::Value makeErrResp(std::string err);
+
+// the response badRequest sends, for coroutine handlers to co_return
+drogon::HttpResponsePtr newErrResponse(std::string err, drogon::HttpStatusCode code = drogon::k400BadRequest);
+
+// A 304 when If-None-Match already holds etag, or nullptr when the client
+// has to get the body. Read the tag before querying and put it on the 200
+// as ETag otherwise.
+drogon::HttpResponsePtr notModifiedResponse(const drogon::HttpRequestPtr &req, const std::string &etag);
+
+// X-Total-Count for a whole table; left out until RowCountPlugin has counted
+void addTotalCountHeader(const drogon::HttpResponsePtr &resp, RowCountPlugin::Table table);
+
+// 200 with a chunked JSON array body; element(i, out) runs as the client reads
+drogon::HttpResponsePtr newJsonArrayStreamResponse(std::size_t count, JsonArrayWriter::Element element);
+// the same, also handing the body to fill once it has all been sent
+drogon::HttpResponsePtr newJsonArrayStreamResponse(std::size_t count, JsonArrayWriter::Element element, std::shared_ptr<ResponseCachePlugin::Fill> fill);
+
+// [{"id": .., "headcount": ..}, ...] for (id, headcount) pairs
+Json::Value countsToJson(const std::vector<std::pair<int32_t, int32_t>> &counts);
+
+// "{1,2,3}", for binding an int list as a single $n::int[] parameter
+std::string toPgIntArray(const std::vector<int32_t> &values);
+// the same with NULL for the empty ones
+std::string toPgIntArray(const std::vector<std::optional<int32_t>> &values);
+
+// binds a JSON scalar as the next statement parameter; arrays and objects
+// are bound as their JSON text
+void bindJsonValue(drogon::orm::internal::SqlBinder &binder, const Json::Value &value);
+
+// most rows a page request gets, whatever ?limit asks for
+constexpr int kMaxPageLimit = 1000;
+
+// ?limit, fallback when absent and capped at kMaxPageLimit; empty when negative
+std::optional<int> pageLimitOf(const drogon::HttpRequestPtr &req, int fallback = 25);
+// ?offset, 0 when absent; empty when negative
+std::optional<int> pageOffsetOf(const drogon::HttpRequestPtr &req);
+
+// Keyset pagination token: the sort a page was read with, plus the sort key
+// and id of its last row. Handed to clients as an opaque url-safe string.
+struct PageCursor {
+    std::string sortField;
+    std::string sortOrder;
+    int32_t id;
+    std::string key;
+};
+
+std::string encodeCursor(const PageCursor &cursor);
+std::optional<PageCursor> decodeCursor(const std::string &token);
+
+// One id ordered page (?limit, ?cursor) of the persons whose foreignKey is
+// parentId, or a 404 when parentTableName has no such row. Both come from a
+// single query.
+drogon::Task<drogon::HttpResponsePtr> getPersonsOf(drogon::HttpRequestPtr req,
+                                                   RowCountPlugin::Table parentTable,
+                                                   std::string parentTableName,
+                                                   std::string foreignKey,
+                                                   int parentId);
+
+// co_await CommitAwaiter(std::move(transPtr)) commits the transaction by
+// dropping the last reference to it, and gives whether the commit went
+// through. It gives false straight away, rolling back, when something else
+// still holds the transaction, and when the transaction was already rolled
+// back so drogon drops the commit callback without calling it.
+class CommitAwaiter : public drogon::CallbackAwaiter<bool> {
+ public:
+    explicit CommitAwaiter(std::shared_ptr<drogon::orm::Transaction> transPtr) : transPtr_(std::move(transPtr)) {}
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        if (transPtr_.use_count() != 1) {
+            LOG_ERROR << "transaction still referenced when committing";
+            transPtr_->rollback();
+            transPtr_.reset();
+            setValue(false);
+            return false;
+        }
+        // every copy of the callback holds alive, so it expiring says the
+        // callback is gone, called or not
+        auto alive = std::make_shared<bool>();
+        std::weak_ptr<bool> watch = alive;
+        transPtr_->setCommitCallback([this, handle, alive = std::move(alive)](bool committed) {
+            setValue(committed);
+            // the commit may land on a db loop while await_suspend still
+            // runs; whichever of the two comes second resumes
+            if (finished_.exchange(true, std::memory_order_acq_rel)) handle.resume();
+        });
+        transPtr_.reset();
+        auto dropped = watch.expired();
+        // already committed: carry on without suspending
+        if (finished_.exchange(true, std::memory_order_acq_rel)) return false;
+        if (dropped) {
+            setValue(false);
+            return false;
+        }
+        return true;
+    }
+
+ private:
+    std::shared_ptr<drogon::orm::Transaction> transPtr_;
+    std::atomic<bool> finished_{false};
+};